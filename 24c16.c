@@ -3,9 +3,6 @@
 #include "24c16.h"
 
 #include <stdio.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -76,35 +73,23 @@ char verify_checksum(t_eeprom_data* data)
 int eeprom_open(t_24c16 *eeprom, unsigned char i2c_address)
 {
 	// local variables
-	int fd;
 	char s;
 	int ret_code = 0;
 	char offset = 0x00;
 
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
+	// register eeprom on its I2C bus
+	if (i2cbus_open(&eeprom->dev, "24C16", eeprom->bus, i2c_address) != 0)
+		return 1;
 
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		ret_code = 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
-		ret_code = 1;
-	}
-
-	// assign file handle to sensor object
-	eeprom->fd = fd;
 	eeprom->address = i2c_address;
 
 	//write address offset to eeprom
-	if ((write(eeprom->fd, (void*)&offset, 1)) != 1) {				// Send register we want to read from
+	if ((i2cbus_write(&eeprom->dev, (void*)&offset, 1)) != 1) {				// Send register we want to read from
 		//fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 		ret_code = 1;
 	}
 
-	if (read(eeprom->fd, &s, 1) != 1) {		// Read back data into buf[]
+	if (i2cbus_read(&eeprom->dev, &s, 1) != 1) {		// Read back data into buf[]
 		ret_code = 1;
 	}
 
@@ -137,7 +122,7 @@ char eeprom_write(t_24c16 *eeprom, char *s, unsigned char offset, unsigned char
 		buf[1]=*(s);
 		//fprintf(stderr, "buf[1]: '%c'\n",buf[1]);
 		// Write data to EEPROM
-		if ((write(eeprom->fd, &buf[0], 2)) != 2) {				// Send register we want to read from
+		if ((i2cbus_write(&eeprom->dev, &buf[0], 2)) != 2) {				// Send register we want to read from
 			fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 			return(1);
 		}
@@ -153,12 +138,12 @@ char eeprom_write(t_24c16 *eeprom, char *s, unsigned char offset, unsigned char
 char eeprom_read(t_24c16 *eeprom, char *s, char offset, char count)
 {
 	//write address offset to eeprom
-	if ((write(eeprom->fd, &offset, 1)) != 1) {				// Send register we want to read from
+	if ((i2cbus_write(&eeprom->dev, &offset, 1)) != 1) {				// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 		return(1);
 	}
 
-	if (read(eeprom->fd, s, count) != count) {		// Read back data into buf[]
+	if (i2cbus_read(&eeprom->dev, s, count) != count) {		// Read back data into buf[]
 		fprintf(stderr, "Unable to read from slave\n");
 		return(1);
 	}
@@ -1,11 +1,16 @@
+#include "i2cbus.h"
+
+#include <stdint.h>
+
 #define EEPROM_ADR 0x50
 
 #define EEPROM_DATA_VERSION 1
 
 // define struct for MS5611 sensor
 typedef struct {
-	int fd;
+	t_i2cdev dev;
 	unsigned char address;
+	uint8_t bus;
 } t_24c16;
 
 typedef struct {
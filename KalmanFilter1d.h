@@ -17,6 +17,8 @@
     along with this program; if not, see <http://www.gnu.org/licenses/>.
 */
 
+#pragma once
+
 typedef struct {
 	float x_abs_;		// the absolute quantity x
 	float x_vel_;		// the rate of change of x, in x units per second squared.
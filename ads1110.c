@@ -22,47 +22,32 @@
 
 #include <time.h>
 #include <stdio.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
-#include <errno.h>
 #include <string.h>
 
 int ads1110_open(t_ads1110 *sensor, unsigned char i2c_address)
 {
 	// local variables
-	int fd;
 	unsigned char buf[10]={0x00};
 
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// register sensor on its I2C bus
+	if (i2cbus_open(&sensor->dev, "ADS1110", sensor->bus, i2c_address) != 0) {
 		sensor->present = 0;
 		return 1;
 	}
 
 	// Try to read from sensor to check if it present
-	if (read(fd, buf, 3) != 3)
+	if (i2cbus_read(&sensor->dev, buf, 3) != 3)
 	{
+		i2cbus_close(&sensor->dev);
 		sensor->present = 0;
 		return (1);
 	}
 
 	if (g_debug > 0) fprintf(stderr, "Opened ADS1110 on 0x%x\n", i2c_address);
 
-	// assign file handle to sensor object
-	sensor->fd = fd;
 	sensor->address = i2c_address;
 	sensor->present = 1;
 	return (0);
@@ -85,7 +70,7 @@ int ads1110_measure(t_ads1110 *sensor)
   //int digoutp;
 
 
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	if (i2cbus_read(&sensor->dev, buf, 3) != 3) {								// Read back data into buf[]
 		fprintf(stderr, "Unable to read from slave\n");
 		return(1);
 	}
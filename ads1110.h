@@ -19,14 +19,19 @@
 
 #pragma once
 
+#include "i2cbus.h"
+
+#include <stdint.h>
+
 // define struct for AMS5915 sensor
 typedef struct {
 	float scale;
 	float offset;
 	int voltage_raw;
 	float voltage_converted;
-	int fd;
+	t_i2cdev dev;
 	unsigned char address;
+	uint8_t bus;
 	unsigned char present;
 } t_ads1110;
 
@@ -0,0 +1,96 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "airdata.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+* @brief Create the shared memory segment for the air data
+* @param name segment name
+* @return pointer to the segment, NULL on error
+*
+* An existing segment is reused, so readers which are attached keep
+* working across a restart of sensord.
+*
+* @date 18.10.2026 born
+*
+*/
+t_airdata_shm *airdata_create(const char *name)
+{
+	t_airdata_shm *shm;
+	int fd;
+
+	fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "shm_open %s failed: %s\n", name, strerror(errno));
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(*shm)) < 0) {
+		fprintf(stderr, "ftruncate %s failed: %s\n", name, strerror(errno));
+		close(fd);
+		return NULL;
+	}
+	shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		fprintf(stderr, "mmap %s failed: %s\n", name, strerror(errno));
+		return NULL;
+	}
+
+	// readers of an older layout see the new magic or version and detach
+	if ((shm->magic != AIRDATA_MAGIC) || (shm->version != AIRDATA_VERSION) || (shm->size != sizeof(*shm))) {
+		atomic_store(&shm->seq, 0);
+		memset(&shm->data, 0, sizeof(shm->data));
+		shm->size = sizeof(*shm);
+		shm->version = AIRDATA_VERSION;
+		shm->magic = AIRDATA_MAGIC;
+	}
+	return shm;
+}
+
+/**
+* @brief Publish the latest air data
+* @param shm pointer to the segment
+* @param a
+* @return
+*
+* Sequence lock, the writer never waits for a reader.
+*
+* @date 18.10.2026 born
+*
+*/
+void airdata_publish(t_airdata_shm *shm, const t_airdata *a)
+{
+	unsigned int seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+
+	// an odd value is left behind if sensord died during an update
+	seq |= 1;
+	atomic_store_explicit(&shm->seq, seq, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	shm->data = *a;
+	atomic_store_explicit(&shm->seq, seq + 1, memory_order_release);
+}
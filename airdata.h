@@ -0,0 +1,151 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+/*
+ * Latest air data of sensord in POSIX shared memory.
+ *
+ * sensord updates the segment on every sensor tick under a sequence lock.
+ * This header is all a reader needs, link with -lrt on older C libraries:
+ *
+ *	const t_airdata_shm *shm = airdata_attach(AIRDATA_SHM_NAME);
+ *	t_airdata a;
+ *
+ *	if ((shm != NULL) && (airdata_read(shm, &a) == 0))
+ *		printf("%f m/s\n", a.vario);
+ *
+ * Attaching costs a few syscalls, reading costs none. A reader should
+ * compare a.time against its own CLOCK_MONOTONIC, the segment stays in
+ * place with the last values when sensord exits.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define AIRDATA_SHM_NAME "/sensord"
+#define AIRDATA_MAGIC 0x41524941	// "AIRA"
+#define AIRDATA_VERSION 1
+
+// validity flags
+#define AIRDATA_TEP_VALID 0x01		// vario and TE pressure
+#define AIRDATA_VOLTAGE_VALID 0x02
+#define AIRDATA_TEMP_VALID 0x04		// a temperature was read within AIRDATA_TIMEOUT
+#define AIRDATA_HUMIDITY_VALID 0x08	// a humidity was read within AIRDATA_TIMEOUT
+
+// age in s of a temperature or humidity reading until it is no longer valid
+#define AIRDATA_TIMEOUT 10
+
+// number of attempts to get a consistent copy
+#define AIRDATA_READ_RETRIES 100
+
+typedef struct {
+	int64_t time;			// sensor tick, CLOCK_MONOTONIC in ns
+	int64_t temp_time;		// last temperature reading, CLOCK_MONOTONIC in ns
+	int64_t humidity_time;		// last humidity reading, CLOCK_MONOTONIC in ns
+	uint32_t tick;			// sensor tick counter
+	uint32_t flags;			// AIRDATA_*_VALID
+	float vario;			// in m/s
+	float p_static;			// in Pa
+	float p_tep;			// in Pa
+	float p_dynamic;		// in Pa
+	float voltage;			// in V
+	float temperature;		// in degC
+	float humidity;			// in %RH
+	float reserved;
+} t_airdata;
+
+// layout of the segment, magic and version never change once created
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;			// sizeof(t_airdata_shm)
+	atomic_uint seq;		// odd while an update is in progress
+	t_airdata data;
+} t_airdata_shm;
+
+/**
+* @brief Map the air data segment of sensord read-only
+* @param name segment name, usually AIRDATA_SHM_NAME
+* @return pointer to the segment, NULL if missing or of another layout
+*
+* @date 18.10.2026 born
+*
+*/
+static inline const t_airdata_shm *airdata_attach(const char *name)
+{
+	t_airdata_shm *shm;
+	int fd;
+
+	fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+	shm = mmap(NULL, sizeof(*shm), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED)
+		return NULL;
+
+	if ((shm->magic != AIRDATA_MAGIC) || (shm->version != AIRDATA_VERSION) || (shm->size != sizeof(*shm))) {
+		munmap(shm, sizeof(*shm));
+		return NULL;
+	}
+	return shm;
+}
+
+static inline void airdata_detach(const t_airdata_shm *shm)
+{
+	munmap((void *)shm, sizeof(*shm));
+}
+
+/**
+* @brief Copy the latest air data
+* @param shm pointer to the segment
+* @param a
+* @return 0 on success, 1 if nothing was published yet or no consistent copy was made
+*
+* @date 18.10.2026 born
+*
+*/
+static inline int airdata_read(const t_airdata_shm *shm, t_airdata *a)
+{
+	atomic_uint *seqp = (atomic_uint *)&shm->seq;
+	unsigned int seq;
+	int i;
+
+	for (i = 0; i < AIRDATA_READ_RETRIES; i++) {
+		seq = atomic_load_explicit(seqp, memory_order_acquire);
+		if (seq == 0)
+			return 1;
+		if (seq & 1)
+			continue;
+		*a = shm->data;
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(seqp, memory_order_relaxed) == seq)
+			return 0;
+	}
+	return 1;
+}
+
+// sensord side, in airdata.c
+t_airdata_shm *airdata_create(const char *);
+void airdata_publish(t_airdata_shm *, const t_airdata *);
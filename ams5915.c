@@ -22,14 +22,10 @@
 
 #include <time.h>
 #include <stdio.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
-#include <errno.h>
 #include <string.h>
 
 /**
@@ -43,26 +39,12 @@
 */
 int ams5915_open(t_ams5915 *sensor, unsigned char i2c_address)
 {
-	// local variables
-	int fd;
-
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// register sensor on its I2C bus
+	if (i2cbus_open(&sensor->dev, "AMS5915", sensor->bus, i2c_address) != 0)
 		return 1;
-	}
 
 	if (g_debug > 0) fprintf(stderr, "Opened AMS5915 on 0x%x\n", i2c_address);
 
-	// assign file handle to sensor object
-	sensor->fd = fd;
 	sensor->address = i2c_address;
 	return (0);
 }
@@ -101,7 +83,7 @@ int ams5915_measure(t_ams5915 *sensor)
 	//variables
 	uint8_t buf[10]={0x00};
 
-	if (read(sensor->fd, buf, 4) != 4) {								// Read back data into buf[]
+	if (i2cbus_read(&sensor->dev, buf, 4) != 4) {								// Read back data into buf[]
 		fprintf(stderr, "Unable to read from slave\n");
 		return(1);
 	}
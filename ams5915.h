@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include "i2cbus.h"
+
 #include <time.h>
 #include <stdint.h>
 
@@ -26,8 +28,9 @@
 
 // define struct for AMS5915 sensor
 typedef struct {
-	int fd;
+	t_i2cdev dev;
 	unsigned char address;
+	uint8_t bus;
 	uint16_t digoutpmin;
 	uint16_t digoutpmax;
 	uint16_t digoutp;
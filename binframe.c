@@ -0,0 +1,108 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "binframe.h"
+#include "crc32.h"
+
+#include <string.h>
+
+static uint8_t *put_u8(uint8_t *p, uint8_t v)
+{
+	*p++ = v;
+	return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+	return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+	p = put_u32(p, v);
+	return put_u32(p, v >> 32);
+}
+
+static uint8_t *put_float(uint8_t *p, float f)
+{
+	uint32_t v;
+
+	memcpy(&v, &f, sizeof(v));
+	return put_u32(p, v);
+}
+
+// add sync, header and CRC around a payload of len bytes at buf + BINFRAME_HEADER_SIZE
+static size_t binframe_finish(uint8_t *buf, uint8_t type, size_t len)
+{
+	buf[0] = BINFRAME_SYNC0;
+	buf[1] = BINFRAME_SYNC1;
+	buf[2] = type;
+	buf[3] = len;
+	put_u32(buf + BINFRAME_HEADER_SIZE + len, crc32_ieee(buf + 2, len + 2));
+	return BINFRAME_HEADER_SIZE + len + BINFRAME_CRC_SIZE;
+}
+
+/**
+* @brief Encode a sample as binary frame
+* @param buf at least BINFRAME_MAX_SIZE bytes
+* @param s sample of the acquisition thread
+* @param vario in m/s
+* @return frame length
+*
+* @date 18.10.2026 born
+*
+*/
+size_t binframe_sample(uint8_t *buf, const t_sample *s, float vario)
+{
+	uint8_t *p = buf + BINFRAME_HEADER_SIZE;
+	uint8_t flags = 0;
+
+	if (s->tep_valid == 1) flags |= BINFRAME_TEP_VALID;
+	if (s->reject) flags |= BINFRAME_REJECT;
+
+	p = put_u32(p, s->seq);
+	p = put_u64(p, (int64_t)s->time.tv_sec * 1000000000 + s->time.tv_nsec);
+	p = put_float(p, s->late);
+	p = put_float(p, s->p_static);
+	p = put_float(p, s->p_tep);
+	p = put_float(p, s->p_dynamic*100);
+	p = put_float(p, s->p_static_raw);
+	p = put_float(p, s->p_dynamic_raw*100);
+	p = put_float(p, s->x_abs);
+	p = put_float(p, s->x_vel);
+	p = put_float(p, vario);
+	p = put_float(p, s->voltage);
+	p = put_u32(p, s->static_D1);
+	p = put_u32(p, s->static_D1f);
+	p = put_u32(p, s->static_D2);
+	p = put_u32(p, s->static_D2f);
+	p = put_u32(p, s->tep_D1);
+	p = put_u32(p, s->tep_D1f);
+	p = put_u32(p, s->tep_D2);
+	p = put_u32(p, s->tep_D2f);
+	p = put_u32(p, s->glitch);
+	p = put_u8(p, flags);
+
+	return binframe_finish(buf, BINFRAME_SAMPLE, p - (buf + BINFRAME_HEADER_SIZE));
+}
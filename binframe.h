@@ -0,0 +1,76 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+/*
+ * Binary output stream, one frame per sensor tick.
+ *
+ * All values are little-endian. A frame is
+ *
+ *	0xa5 0x5a	sync
+ *	uint8		type
+ *	uint8		payload length
+ *	payload
+ *	uint32		CRC-32 of type, length and payload
+ *
+ * A receiver which loses sync searches for the next sync bytes and checks
+ * the CRC. Unknown types are skipped by their length.
+ *
+ * BINFRAME_SAMPLE payload:
+ *
+ *	uint32		sample counter
+ *	int64		tick time, CLOCK_MONOTONIC in ns
+ *	float		tick lateness in us
+ *	float		filtered static pressure in Pa
+ *	float		TE pressure in Pa
+ *	float		filtered dynamic pressure in Pa
+ *	float		static pressure of this tick in Pa
+ *	float		dynamic pressure of this tick in Pa
+ *	float		Kalman filter altitude state
+ *	float		Kalman filter climb state
+ *	float		vario in m/s
+ *	float		voltage in V
+ *	uint32		static D1, D1f, D2, D2f
+ *	uint32		TE D1, D1f, D2, D2f
+ *	int32		glitch
+ *	uint8		flags, BINFRAME_TEP_VALID, BINFRAME_REJECT
+ */
+
+#include "ring.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BINFRAME_SYNC0 0xa5
+#define BINFRAME_SYNC1 0x5a
+
+// frame types
+#define BINFRAME_SAMPLE 0x01
+
+// sample flags
+#define BINFRAME_TEP_VALID 0x01
+#define BINFRAME_REJECT 0x02
+
+#define BINFRAME_HEADER_SIZE 4
+#define BINFRAME_CRC_SIZE 4
+#define BINFRAME_MAX_SIZE (BINFRAME_HEADER_SIZE + 255 + BINFRAME_CRC_SIZE)
+
+size_t binframe_sample(uint8_t *, const t_sample *, float);
@@ -32,17 +32,26 @@ static inline float timespec_delta_us(const struct timespec *a,
 	return timespec_delta_s(a, b) * 1000000;
 }
 
+static inline int timespec_before(const struct timespec *a,
+				  const struct timespec *b)
+{
+	return (a->tv_sec < b->tv_sec) ||
+		((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
 static inline void timespec_add_ns(struct timespec *t, unsigned long ns)
 {
 	t->tv_nsec += ns;
 
-	if (t->tv_nsec > 1000000000) {
+	if (t->tv_nsec >= 1000000000) {
 		t->tv_nsec -= 1000000000;
 		++t->tv_sec;
 	}
 }
 
+// also for delays of more than a second
 static inline void timespec_add_us(struct timespec *t, unsigned long us)
 {
-	timespec_add_ns(t, us * 1000);
+	t->tv_sec += us / 1000000;
+	timespec_add_ns(t, (us % 1000000) * 1000);
 }
@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <getopt.h>
+#include <sched.h>
 
 char config_filename[50];
 
@@ -31,9 +33,18 @@ bool g_foreground = false;
 bool g_inetd = false;
 bool g_secordcomp = false;
 bool tj = false;
+bool g_realtime = false;
+int g_rt_priority = 50;
+int g_rt_cpu = -1;
+int g_listen_port = 0;
+bool g_simulate = false;
+bool g_replay_paced = false;
+char simulate_filename[50];
+char binlog_filename[50];
 
 FILE *fp_sensordata=NULL;
 FILE *fp_datalog=NULL;
+FILE *fp_rawlog=NULL;
 FILE *fp_config=NULL;
 
 void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
@@ -42,6 +53,7 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 	int c;
 	char datalog_filename[50];
 	char sensordata_filename[50];
+	char rawlog_filename[50];
 
 	const char* Usage = "\n"\
 	"  -v              print version information\n"\
@@ -53,10 +65,30 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 	"  -r [filename]   record measurement values to file\n"\
 	"  -s              second order temperature compensation for MS5611 enable\n"\
 	"  -p [filename]   use values from file instead of measuring\n"\
+	"  -P, --paced     replay -p in the recorded timing, default is as fast as possible\n"\
+	"  -w [filename]   record raw sensor words to file, for replay with -p\n"\
+	"  -b [filename]   binary recording to [filename].000, .001, ..., see recdump\n"\
+	"  -R[prio], --realtime[=prio]\n"\
+	"                  real time mode, SCHED_FIFO priority [1..99]. default=50\n"\
+	"  -a [cpu], --cpu=[cpu]\n"\
+	"                  pin the acquisition thread to cpu (real time mode)\n"\
+	"  -L[port], --listen[=port]\n"\
+	"                  serve NMEA clients on port instead of connecting. default=4353\n"\
+	"  -S[filename], --simulate[=filename]\n"\
+	"                  simulated sensors, flight profile and faults from [filename]\n"\
 	"\n";
 
+	static const struct option long_options[] = {
+		{"realtime", optional_argument, NULL, 'R'},
+		{"cpu", required_argument, NULL, 'a'},
+		{"listen", optional_argument, NULL, 'L'},
+		{"simulate", optional_argument, NULL, 'S'},
+		{"paced", no_argument, NULL, 'P'},
+		{NULL, 0, NULL, 0}
+	};
+
 	// check commandline arguments
-	while ((c = getopt (argc, argv, "vd::fijlhr:p:c:s")) != -1)
+	while ((c = getopt_long (argc, argv, "vd::fijlhr:p:Pw:b:c:sR::a:S::L::", long_options, NULL)) != -1)
 	{
 		switch (c) {
 			case 'v':
@@ -146,6 +178,28 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 				fp_datalog = fopen(datalog_filename,"w+");
 				break;
 
+			case 'w':
+				// record raw sensor words for replay through the glitch compensation
+				io_mode->rawdata_to_file = true;
+				snprintf(rawlog_filename, sizeof(rawlog_filename), "%s", optarg);
+				fprintf(stderr, "!! RECORD RAW DATA TO %s !!\n", rawlog_filename);
+
+				fp_rawlog = fopen(rawlog_filename,"w");
+				if (fp_rawlog == NULL)
+				{
+					fprintf(stderr, "Error opening file %s for recording !!\n", rawlog_filename);
+					fprintf(stderr, "Exiting ...\n");
+					exit(EXIT_FAILURE);
+				}
+				break;
+
+			case 'b':
+				// binary recording, written by a thread of its own
+				io_mode->binary_to_file = true;
+				snprintf(binlog_filename, sizeof(binlog_filename), "%s", optarg);
+				fprintf(stderr, "!! RECORD BINARY DATA TO %s !!\n", binlog_filename);
+				break;
+
 			case 'p':
 				// replay sensordata instead of measuring
 				if (optarg == NULL)
@@ -168,6 +222,59 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 				}
 				break;
 
+			case 'P':
+				// replay in the recorded timing
+				g_replay_paced = true;
+				break;
+
+			case 'R':
+				// real time scheduling
+				g_realtime = true;
+				if (optarg != NULL)
+					g_rt_priority = atoi(optarg);
+				if ((g_rt_priority < 1) || (g_rt_priority > 99))
+				{
+					fprintf(stderr, "Invalid real time priority %d\n", g_rt_priority);
+					fprintf(stderr, "Exiting ...\n");
+					exit(EXIT_FAILURE);
+				}
+				fprintf(stderr, "!! REAL TIME MODE, PRIORITY %d !!\n", g_rt_priority);
+				break;
+
+			case 'a':
+				// cpu affinity of the acquisition thread
+				{
+					char *end;
+					long cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+					g_rt_cpu = strtol(optarg, &end, 10);
+					if ((*end != '\0') || (end == optarg) || (g_rt_cpu < 0) || (g_rt_cpu >= cpus) || (g_rt_cpu >= CPU_SETSIZE))
+					{
+						fprintf(stderr, "Invalid cpu %s, %ld cpus present\n", optarg, cpus);
+						fprintf(stderr, "Exiting ...\n");
+						exit(EXIT_FAILURE);
+					}
+				}
+				break;
+
+			case 'L':
+				// server mode, -l has always been accepted and ignored
+				g_listen_port = (optarg != NULL) ? atoi(optarg) : 4353;
+				if ((g_listen_port < 1) || (g_listen_port > 65535))
+				{
+					fprintf(stderr, "Invalid port %d\n", g_listen_port);
+					fprintf(stderr, "Exiting ...\n");
+					exit(EXIT_FAILURE);
+				}
+				break;
+
+			case 'S':
+				// simulated I2C devices instead of the hardware
+				g_simulate = true;
+				if (optarg != NULL)
+					snprintf(simulate_filename, sizeof(simulate_filename), "%s", optarg);
+				break;
+
 			case '?':
 				fprintf(stderr, "Unknown option %c\n", optopt);
 				fprintf(stderr, "Usage: sensord [OPTION]\n%s",Usage);
@@ -30,9 +30,18 @@ extern bool g_foreground;
 extern bool g_inetd;
 extern bool g_secordcomp;
 extern bool tj;
+extern bool g_realtime;
+extern int g_rt_priority;
+extern int g_rt_cpu;
+extern int g_listen_port;
+extern bool g_simulate;
+extern bool g_replay_paced;
+extern char simulate_filename[50];
+extern char binlog_filename[50];
 
 extern FILE *fp_sensordata;
 extern FILE *fp_datalog;
+extern FILE *fp_rawlog;
 extern FILE *fp_config;
 
 void cmdline_parser(int argc, char **argv, t_io_mode *);
@@ -110,11 +110,8 @@ static void pressure_measurement_handler(int record)
 	if ((sensor_wait(12500))>2000) { glitchstart=8; glitch+=8; }
 	if (meas_counter&1) {
 		// read pressure sensors
-		x|=ms5611_read_temp(&tep_sensor,glitch);
-		x|=ms5611_read_pressure(&static_sensor);
-		x|=ms5611_start_pressure(&tep_sensor);
+		x|=ms5611_transfer(&tep_sensor,&static_sensor,1,glitch);
 		sensor_wait_mark();
-		x|=ms5611_start_temp(&static_sensor);
 
 		if (abs((int)static_sensor.D1l-(int) static_sensor.D1)<100e3) {
 			if (glitch==0) {
@@ -155,11 +152,8 @@ static void pressure_measurement_handler(int record)
 		}
 	} else {
 		// read pressure sensors
-		x|=ms5611_read_pressure(&tep_sensor);
-		x|=ms5611_read_temp(&static_sensor,glitch);
-		x|=ms5611_start_temp(&tep_sensor);
+		x|=ms5611_transfer(&tep_sensor,&static_sensor,0,glitch);
 		sensor_wait_mark();
-		x|=ms5611_start_pressure(&static_sensor);
 
 		if (abs((int)tep_sensor.D1l-(int) tep_sensor.D1)<100e3) {
 			if (glitch==0) {
@@ -369,7 +363,7 @@ int main (int argc, char **argv) {
 	tio.c_lflag |= ICANON | ECHO;
 	tcsetattr( 0, TCSANOW, &tio );
 
-	if (ms5611_open(&static_sensor) != 0)
+	if (ms5611_open(&static_sensor, "MS5611 static") != 0)
 	{
 		fprintf(stderr, "Open static sensor failed !!\n");
 		return 1;
@@ -383,7 +377,7 @@ int main (int argc, char **argv) {
 	static_sensor.valid = 1;
 
 	// open sensor for velocity pressure
-	if (ms5611_open(&tep_sensor) != 0)
+	if (ms5611_open(&tep_sensor, "MS5611 TE") != 0)
 	{
 		fprintf(stderr, "Open tep sensor failed !!\n");
 		return 1;
@@ -22,6 +22,8 @@
 #include "ms5611.h"
 #include "ams5915.h"
 #include "ads1110.h"
+#include "server.h"
+#include "recorder.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,6 +31,35 @@
 #include <math.h>
 #include <ctype.h>
 
+// optional rate and filter of a sentence: output_POV_x [rate Hz] [average/last],
+// either may be left out
+static void cfgfile_output_rate(const char *line, t_output_rate *rate)
+{
+	char tag[20], word[20], *end;
+	int pos, n;
+	float value;
+
+	if (sscanf(line, "%19s%n", tag, &pos) != 1)
+		return;
+
+	while (sscanf(line + pos, "%19s%n", word, &n) == 1) {
+		pos += n;
+		if (word[0] == '#')
+			break;
+		if (strcmp(word, "average") == 0)
+			rate->average = 1;
+		else if (strcmp(word, "last") == 0)
+			rate->average = 0;
+		else {
+			value = strtof(word, &end);
+			if ((*end == '\0') && (end != word))
+				rate->rate = value;
+			else
+				fprintf(stderr, "Invalid value %s for %s ignored\n", word, tag);
+		}
+	}
+}
+
 int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_ams5915 *dynamic_sensor, t_ads1110 *voltage_sensor, t_ds2482 *temp_sensor, t_config *config)
 {
 	char line[70];
@@ -56,6 +87,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 					if (strcmp(tmp,"output_POV_E") == 0)
 					{
 						config->output_POV_E = 1;
+						cfgfile_output_rate(line, &config->rate_E);
 						//fprintf(stderr, "OUTput POV_E enabled !! \n");
 					}
 
@@ -63,6 +95,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 					if (strcmp(tmp,"output_POV_P_Q") == 0)
 					{
 						config->output_POV_P_Q = 1;
+						cfgfile_output_rate(line, &config->rate_P_Q);
 						//fprintf(stderr, "OUTput POV_P_Q enabled !! \n");
 					}
 
@@ -70,6 +103,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 					if (strcmp(tmp,"output_POV_V") == 0)
 					{
 						config->output_POV_V= 1;
+						cfgfile_output_rate(line, &config->rate_V);
 						//fprintf(stderr, "OUTput POV_V enabled !! \n");
 					}
 
@@ -159,7 +193,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 					if (strcmp(tmp,"dynamic_sensor") == 0)
 					{
 						// get config data for dynamic sensor
-						sscanf(line, "%19s %f %f", tmp, &dynamic_sensor->offset, &dynamic_sensor->linearity);
+						sscanf(line, "%19s %f %f %hhx %hhu", tmp, &dynamic_sensor->offset, &dynamic_sensor->linearity, &dynamic_sensor->address, &dynamic_sensor->bus);
 					}
 
 					// check for vario config
@@ -173,10 +207,83 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 					if (strcmp(tmp,"voltage_config") == 0)
 					{
 						// get config data for dynamic sensor
-						sscanf(line, "%19s %f %f", tmp, &voltage_sensor->scale,&voltage_sensor->offset);
+						sscanf(line, "%19s %f %f %hhx %hhu", tmp, &voltage_sensor->scale,&voltage_sensor->offset, &voltage_sensor->address, &voltage_sensor->bus);
 						voltage_sensor->scale=1.0/voltage_sensor->scale;
 					}
 
+					// check for temperature sensor bus
+					if (strcmp(tmp,"temp_sensor_bus") == 0) {
+						// get I2C bus of the temperature sensor
+						sscanf(line,"%19s %hhu",tmp, &temp_sensor->bus);
+					}
+
+					// check for warm start snapshot
+					if (strcmp(tmp,"snapshot_file") == 0) {
+						// get snapshot file and max. age
+						sscanf(line,"%19s %63s %d",tmp, config->snapshot_file, &config->snapshot_max_age);
+					}
+
+					// check for temperature sensor cache
+					if (strcmp(tmp,"temp_sensor_cache") == 0) {
+						// get file of the detected temperature sensor
+						sscanf(line,"%19s %63s",tmp, config->probe_cache);
+					}
+
+					// check for client queue of the server mode
+					if (strcmp(tmp,"client_queue") == 0) {
+						char policy[20] = "";
+
+						// get queue size and overflow policy
+						sscanf(line,"%19s %d %19s",tmp, &config->client_queue_size, policy);
+						if (strcmp(policy,"disconnect") == 0)
+							config->client_queue_policy = SERVER_DISCONNECT;
+						else if (strcmp(policy,"drop_oldest") == 0)
+							config->client_queue_policy = SERVER_DROP_OLDEST;
+					}
+
+					// check for listen address of the servers
+					if (strcmp(tmp,"listen_address") == 0) {
+						// get IPv4 address of the servers
+						sscanf(line,"%19s %15s",tmp, config->listen_address);
+					}
+
+					// check for binary output stream
+					if (strcmp(tmp,"binary_port") == 0) {
+						// get TCP port of the binary stream
+						sscanf(line,"%19s %d",tmp, &config->binary_port);
+					}
+
+					// check for metrics socket
+					if (strcmp(tmp,"metrics_socket") == 0) {
+						// get path of the Unix socket
+						sscanf(line,"%19s %63s",tmp, config->metrics_socket);
+					}
+
+					// check for binary recording file size
+					if (strcmp(tmp,"record_file_size") == 0) {
+						// get size of one file in MB
+						sscanf(line,"%19s %d",tmp, &config->record_file_size);
+					}
+
+					// check for binary recording format
+					if (strcmp(tmp,"record_format") == 0) {
+						char format[16] = "";
+
+						sscanf(line,"%19s %15s",tmp, format);
+						if (strcmp(format,"delta") == 0)
+							config->record_format = RECORDER_DELTA;
+						else if (strcmp(format,"full") == 0)
+							config->record_format = RECORDER_FULL;
+						else
+							fprintf(stderr, "Unknown record format %s\n", format);
+					}
+
+					// check for shared memory publication
+					if (strcmp(tmp,"airdata_shm") == 0) {
+						// get name of the shared memory segment
+						sscanf(line,"%19s %63s",tmp, config->airdata_shm);
+					}
+
 					// check for temperature sensor config
 					if (strcmp(tmp,"temp_databits") == 0) {
 						// get config data for temperature sensor
@@ -23,6 +23,7 @@
 #include "ams5915.h"
 #include "ads1110.h"
 #include "ds2482.h"
+#include "decim.h"
 
 #include <stdio.h>
 
@@ -32,10 +33,24 @@ typedef struct {
 	char output_POV_V;
 	char output_POV_T;
 	char output_POV_H;
+	t_output_rate rate_E;
+	t_output_rate rate_P_Q;
+	t_output_rate rate_V;
 	float vario_x_accel;
 	double timing_log;
 	double timing_mult;
 	double timing_off;
+	char snapshot_file[64];		// warm start snapshot, empty if disabled
+	int snapshot_max_age;		// in s
+	char probe_cache[64];		// detected temperature sensor, empty if disabled
+	int client_queue_size;		// per client in server mode, in bytes
+	int client_queue_policy;	// SERVER_DROP_OLDEST or SERVER_DISCONNECT
+	char listen_address[16];	// of the NMEA and binary servers
+	char airdata_shm[64];		// shared memory segment, empty if disabled
+	int binary_port;		// binary output stream, 0 if disabled
+	char metrics_socket[64];	// Unix socket of the metrics, empty if disabled
+	int record_file_size;		// binary recording, in MB per file
+	int record_format;		// RECORDER_FULL or RECORDER_DELTA
 } t_config;
 
 int cfgfile_parser(FILE *, t_ms5611 *, t_ms5611 *, t_ams5915 *, t_ads1110 *, t_ds2482 *, t_config *);
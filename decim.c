@@ -0,0 +1,80 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "decim.h"
+
+#include <math.h>
+
+/**
+* @brief Set up the decimation to a sentence rate
+* @param d pointer to decimation instance
+* @param r configured rate, rounded to a whole number of sensor ticks
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void decim_init(t_decim *d, const t_output_rate *r)
+{
+	int i;
+
+	d->divider = (r->rate > 0) ? lroundf(DECIM_TICK_RATE / r->rate) : DECIM_TICK_RATE / DECIM_DEFAULT_RATE;
+	if (d->divider < 1) d->divider = 1;
+	d->average = r->average;
+	d->n = 0;
+	for (i = 0; i < DECIM_MAX_VALUES; i++)
+		d->sum[i] = 0;
+}
+
+/**
+* @brief Feed the values of a sensor tick
+* @param d pointer to decimation instance
+* @param tick sensor tick counter
+* @param in values of this tick
+* @param out values to send
+* @param nvalues number of values, up to DECIM_MAX_VALUES
+* @return 1 if the sentence is due, 0 otherwise
+*
+* Averaging is a box filter over the ticks since the last output, a
+* first-order CIC filter without the integer arithmetic.
+*
+* @date 18.10.2026 born
+*
+*/
+int decim_step(t_decim *d, unsigned long tick, const float *in, float *out, int nvalues)
+{
+	int i;
+
+	if (d->average) {
+		for (i = 0; i < nvalues; i++)
+			d->sum[i] += in[i];
+		d->n++;
+	}
+
+	if (tick % d->divider != 0)
+		return 0;
+
+	for (i = 0; i < nvalues; i++) {
+		out[i] = d->average ? d->sum[i] / d->n : in[i];
+		d->sum[i] = 0;
+	}
+	d->n = 0;
+	return 1;
+}
@@ -0,0 +1,46 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// sensor ticks per s
+#define DECIM_TICK_RATE 80
+
+// default output rate of the NMEA sentences, every 4th sensor tick
+#define DECIM_DEFAULT_RATE 20
+
+#define DECIM_MAX_VALUES 2
+
+// configured rate of a sentence
+typedef struct {
+	float rate;			// in Hz
+	char average;			// box filter instead of the latest sample
+} t_output_rate;
+
+// decimation of the sensor ticks to the rate of a sentence
+typedef struct {
+	int divider;			// sensor ticks per output
+	char average;
+	int n;
+	double sum[DECIM_MAX_VALUES];
+} t_decim;
+
+void decim_init(t_decim *, const t_output_rate *);
+int decim_step(t_decim *, unsigned long, const float *, float *, int);
@@ -22,13 +22,9 @@
 
 #include <time.h>
 #include <stdio.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
-#include <errno.h>
 #include <string.h>
 
 //http://datasheets.maximintegrated.com/en/ds/DS2482-100.pdf
@@ -42,24 +38,11 @@
 
 int ds2482_open(t_ds2482 *sensor, unsigned char i2c_address)
 {
-	// local variables
-	int fd;
-
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
+	// register interface on its I2C bus
+	if (i2cbus_open(&sensor->dev, "DS2482", sensor->bus, i2c_address) != 0)
 		return 0;
-	}
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
-		return 0;
-	}
 
 	if (g_debug > 0) fprintf(stderr, "Opened DS2482 on 0x%x\n", i2c_address);
-	//assign file handle to sensor object
-	sensor->fd = fd;
 	sensor->address = i2c_address;
 	return 1;
 }
@@ -67,7 +50,7 @@ int ds2482_open(t_ds2482 *sensor, unsigned char i2c_address)
 int ds2482_reset(t_ds2482 *sensor) {
 	//server.log(format("Function: Resetting DS2482 at %i (%#x)", I2CAddr, I2CAddr));
 
-	if (write(sensor->fd, "\xf0", 1)!=1) return 0; //reset DS2482
+	if (i2cbus_write(&sensor->dev, "\xf0", 1)!=1) return 0; //reset DS2482
 	sensor->owDeviceAddress[0]=0;
 	sensor->owDeviceAddress[1]=0;
 	sensor->owTriplet=4;
@@ -84,13 +67,13 @@ int OWReset(t_ds2482 *sensor) {
 	unsigned char data;
 
 	// server.log("Function: I2C Reset");
-	if (write(sensor->fd, "\xb4",1)!=1) { // 1-wire reset
+	if (i2cbus_write(&sensor->dev, "\xb4",1)!=1) { // 1-wire reset
 		// Device failed to acknowledge reset
 		// server.log("I2C Reset Failed");
 		return 0;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,&data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, &data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return 0;
 		} else {
@@ -127,12 +110,12 @@ int OWWriteByte(t_ds2482 *sensor, unsigned char writeval) {
 	unsigned char data[2];
 
 	// server.log("Function: Write Byte to One-Wire");
-	if (write(sensor->fd,"\xe1\xf0",2)!=2) { // Device failed to acknowledge
+	if (i2cbus_write(&sensor->dev, "\xe1\xf0",2)!=2) { // Device failed to acknowledge
 		// server.log("I2C Write Failed");
 		return -1;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return -1;
 		} else {
@@ -154,13 +137,13 @@ int OWWriteByte(t_ds2482 *sensor, unsigned char writeval) {
 	}
 	data[0]=0xa5;
 	data[1]=writeval;
-	if (write(sensor->fd,data,2)!=2) { // set write byte command (A5) and send data (byte)
+	if (i2cbus_write(&sensor->dev, data,2)!=2) { // set write byte command (A5) and send data (byte)
 		// Device failed to acknowledge
 		// server.log(format("I2C Write Byte Failed. Data: %#.2X", byte));
 		return -1;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return -1;
 		} else {
@@ -195,12 +178,12 @@ int OWReadByte(t_ds2482 *sensor) {
 
 	// See if the 1wire bus is idle
 	// server.log("Function: Read Byte from One-Wire");
-	if (write(sensor->fd,"\xe1\xf0",2)!=2) { // Device failed to acknowledge
+	if (i2cbus_write(&sensor->dev, "\xe1\xf0",2)!=2) { // Device failed to acknowledge
 		// server.log("I2C Write Failed");
 		return -1;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,&data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, &data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return -1;
 		} else {
@@ -220,12 +203,12 @@ int OWReadByte(t_ds2482 *sensor) {
 		return -1;
 	}
 	// Send a read command, then wait for the 1wire bus to finish
-	if (write(sensor->fd,"\x96",1)!=1) { // Device failed to acknowledge
+	if (i2cbus_write(&sensor->dev, "\x96",1)!=1) { // Device failed to acknowledge
 		// server.log("I2C Write Read-Request Failed");
 		return -1;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,&data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, &data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return -1;
 		} else {
@@ -246,11 +229,11 @@ int OWReadByte(t_ds2482 *sensor) {
 	}
 
 	// Go get the data byte
-	if (write(sensor->fd,"\xe1\xe1",2)!=2) { // Device failed to acknowledge
+	if (i2cbus_write(&sensor->dev, "\xe1\xe1",2)!=2) { // Device failed to acknowledge
 		// server.log("I2C Write Failed");
 		return -1;
 	}
-	if (read(sensor->fd,&data,1)==0) { // Read the status register
+	if (i2cbus_read(&sensor->dev, &data,1)==0) { // Read the status register
 		// server.log("I2C Read Status Failed");
 		return -1;
 	}
@@ -265,12 +248,12 @@ int OWTriplet(t_ds2482 *sensor) {
 
 	// server.log("Function: OneWire Triplet");
 	data[1]=sensor->owTriplet<<5;
-	if (write(sensor->fd,data,2)!=2) { // Device failed to acknowledge
+	if (i2cbus_write(&sensor->dev, data,2)!=2) { // Device failed to acknowledge
 		// server.log("OneWire Triplet  Failed");
 		return 0;
 	}
 	for (i=0;i<100;++i) {
-		if (read(sensor->fd,&data,1)==0) { // Read the status register
+		if (i2cbus_read(&sensor->dev, &data,1)==0) { // Read the status register
 			// server.log("I2C Read Status Failed");
 			return 0;
 		} else {
@@ -445,19 +428,9 @@ int OWConfigureBits (t_ds2482 *sensor) {
 // 1 = Valid
 // 2 = Appears valid, but resolution doesn't match expected value
 
-int OWReadTemperature(t_ds2482 *sensor) {
-	int data[5];
-	int i,j;
+static int OWDecodeTemperature(t_ds2482 *sensor, const int *data) {
+	int i,j=1;
 
-	sensor->temp_valid=0;
-	for(i=0,j=0; i<5; i++) { // we only need 5 of the bytes
-		// Technically we only need two, but grabbing 5 lets us double check the configuration
-		data[i] = OWReadByte(sensor);
-		if (data[i]<0) j=1;
-		// server.log(format("read byte: %.2X", data[i]));
-	}
-	if (j) return 0;
-	j=1;
 	i = (data[1] << 8) | data[0];
 	switch (data[4]&0x60) {
 		case 0x60 : // server.log("12 bit resolution"); // 750 ms conversion time
@@ -481,3 +454,199 @@ int OWReadTemperature(t_ds2482 *sensor) {
 	debug_print("%s @ 0x18: temperature %f\n",__func__,sensor->temperature);
 	return j;
 }
+
+int OWReadTemperature(t_ds2482 *sensor) {
+	int data[5];
+	int i,j;
+
+	sensor->temp_valid=0;
+	for(i=0,j=0; i<5; i++) { // we only need 5 of the bytes
+		// Technically we only need two, but grabbing 5 lets us double check the configuration
+		data[i] = OWReadByte(sensor);
+		if (data[i]<0) j=1;
+		// server.log(format("read byte: %.2X", data[i]));
+	}
+	if (j) return 0;
+	return OWDecodeTemperature(sensor, data);
+}
+
+// The blocking routines above poll the 1-Wire busy bit with 1 ms sleeps and
+// are only used during startup. While running, 1-Wire traffic goes through
+// the sequencer below. Every call of OWStep() issues exactly one I2C
+// operation and returns, a busy 1-Wire bus is polled again on the next call
+// instead of sleeping. The DS2482 moves its read pointer to the status
+// register with every 1-Wire command, so no extra pointer setup is needed.
+
+#define OW_PHASE_ISSUE 0
+#define OW_PHASE_POLL 1
+#define OW_PHASE_FETCH 2
+
+// 1-Wire busy for too long, 8 calls are 100 ms at the 12.5 ms tick
+#define OW_MAX_POLLS 8
+
+// max. sequencer steps per call of DS18B20Poll
+#define OW_MAX_STEPS 4
+
+#define OW_JOB_IDLE 0
+#define OW_JOB_CONVERT 1
+#define OW_JOB_WAIT 2
+#define OW_JOB_READ 3
+
+static const int ow_convert[] = { OW_OP_RESET, 0xCC, 0x44 };	// Skip ROM, Convert T
+static const int ow_wait[] = { OW_OP_READ };				// reads 1 when conversion is done
+static const int ow_read[] = { OW_OP_RESET, 0xCC, 0xBE,			// Skip ROM, Read Scratchpad
+	OW_OP_READ, OW_OP_READ, OW_OP_READ, OW_OP_READ, OW_OP_READ };
+
+/**
+* @brief Start a sequence of 1-Wire operations
+* @param sensor pointer to sensor instance
+* @param ops list of operations, OW_OP_RESET, OW_OP_READ or a byte to write
+* @param nops number of operations
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void OWStart(t_ds2482 *sensor, const int *ops, int nops) {
+	sensor->ow_ops = ops;
+	sensor->ow_nops = nops;
+	sensor->ow_op = 0;
+	sensor->ow_phase = OW_PHASE_ISSUE;
+	sensor->ow_polls = 0;
+	sensor->ow_nread = 0;
+}
+
+/**
+* @brief Advance the running 1-Wire sequence by one I2C operation
+* @param sensor pointer to sensor instance
+* @return OW_STEP_NEXT if the next step can follow right away,
+*         OW_STEP_BUSY if the 1-Wire bus is busy, OW_STEP_DONE when the
+*         sequence is complete and OW_STEP_FAIL on error
+*
+* @date 18.10.2026 born
+*
+*/
+int OWStep(t_ds2482 *sensor) {
+	int op = sensor->ow_ops[sensor->ow_op];
+	unsigned char data[2];
+
+	switch (sensor->ow_phase) {
+		case OW_PHASE_ISSUE :
+			if (op == OW_OP_RESET) {
+				data[0]=0xb4; // 1-wire reset
+				if (i2cbus_write(&sensor->dev, data, 1)!=1) return OW_STEP_FAIL;
+			} else if (op == OW_OP_READ) {
+				data[0]=0x96; // 1-wire read byte
+				if (i2cbus_write(&sensor->dev, data, 1)!=1) return OW_STEP_FAIL;
+			} else {
+				data[0]=0xa5; // 1-wire write byte
+				data[1]=op;
+				if (i2cbus_write(&sensor->dev, data, 2)!=2) return OW_STEP_FAIL;
+			}
+			sensor->ow_phase = OW_PHASE_POLL;
+			sensor->ow_polls = 0;
+			// the 1-Wire operation takes at least 0.5 ms
+			return OW_STEP_BUSY;
+
+		case OW_PHASE_POLL :
+			if (i2cbus_read(&sensor->dev, data, 1)!=1) return OW_STEP_FAIL; // Read the status register
+			if (data[0] & 1) { // 1-Wire Busy bit
+				i2cbus_retry(&sensor->dev);
+				if (++sensor->ow_polls >= OW_MAX_POLLS) return OW_STEP_FAIL;
+				return OW_STEP_BUSY;
+			}
+			if (op == OW_OP_RESET) {
+				if (data[0] & 4) return OW_STEP_FAIL; // Short Detected bit
+				if (!(data[0] & 2)) return OW_STEP_FAIL; // no Presence-Pulse
+			}
+			if (op == OW_OP_READ) {
+				sensor->ow_phase = OW_PHASE_FETCH;
+				return OW_STEP_NEXT;
+			}
+			break;
+
+		case OW_PHASE_FETCH :
+			// point to the read data register and fetch the byte in one transaction
+			data[0]=0xe1;
+			data[1]=0xe1;
+			i2cbus_begin(sensor->dev.bus);
+			i2cbus_queue_write(&sensor->dev, data, 2);
+			i2cbus_queue_read(&sensor->dev, data, 1);
+			if (i2cbus_flush(sensor->dev.bus) != 0) return OW_STEP_FAIL;
+			if (sensor->ow_nread < (int)(sizeof(sensor->ow_data)/sizeof(sensor->ow_data[0])))
+				sensor->ow_data[sensor->ow_nread++] = data[0];
+			break;
+	}
+
+	if (++sensor->ow_op == sensor->ow_nops) return OW_STEP_DONE;
+	sensor->ow_phase = OW_PHASE_ISSUE;
+	return OW_STEP_NEXT;
+}
+
+/**
+* @brief Start a DS18B20 temperature conversion
+* @param sensor pointer to sensor instance
+* @return
+*
+* The conversion is carried out by subsequent calls of DS18B20Poll().
+*
+* @date 18.10.2026 born
+*
+*/
+void DS18B20StartConversion(t_ds2482 *sensor) {
+	OWStart(sensor, ow_convert, sizeof(ow_convert)/sizeof(ow_convert[0]));
+	sensor->ow_job = OW_JOB_CONVERT;
+}
+
+/**
+* @brief Advance a DS18B20 measurement, called once per tick
+* @param sensor pointer to sensor instance
+* @return OW_PENDING while no temperature is available, otherwise the
+*         result of the temperature conversion as of OWReadTemperature()
+*
+* Starts the conversion, waits for its end and reads the scratchpad. A
+* failed read is retried from waiting for the conversion.
+*
+* @date 18.10.2026 born
+*
+*/
+int DS18B20Poll(t_ds2482 *sensor) {
+	int i, result;
+
+	if (sensor->ow_job == OW_JOB_IDLE) return OW_PENDING;
+
+	for (i = 0; i < OW_MAX_STEPS; i++) {
+		result = OWStep(sensor);
+		if (result == OW_STEP_NEXT) continue;
+		if (result == OW_STEP_BUSY) break;
+
+		switch (sensor->ow_job) {
+			case OW_JOB_CONVERT :
+				// wait for the conversion even if starting it failed, as before
+				OWStart(sensor, ow_wait, 1);
+				sensor->ow_job = OW_JOB_WAIT;
+				break;
+			case OW_JOB_WAIT :
+				if ((result == OW_STEP_DONE) && (sensor->ow_data[0] > 0)) {
+					OWStart(sensor, ow_read, sizeof(ow_read)/sizeof(ow_read[0]));
+					sensor->ow_job = OW_JOB_READ;
+					continue;
+				}
+				OWStart(sensor, ow_wait, 1);
+				break;
+			case OW_JOB_READ :
+				if (result == OW_STEP_DONE) {
+					sensor->ow_job = OW_JOB_IDLE;
+					sensor->temp_valid = 0;
+					return OWDecodeTemperature(sensor, sensor->ow_data);
+				}
+				i2cbus_retry(&sensor->dev);
+				OWStart(sensor, ow_wait, 1);
+				sensor->ow_job = OW_JOB_WAIT;
+				break;
+		}
+		// next sequence starts on the next tick
+		break;
+	}
+	return OW_PENDING;
+}
@@ -21,6 +21,10 @@ rio.org/
 
 #pragma once
 
+#include "i2cbus.h"
+
+#include <stdint.h>
+
 // define struct for DS2482 sensor
 
 #define AUTO 0
@@ -32,9 +36,23 @@ rio.org/
 #define SHT4X 6
 #define SHT85 7
 
+// 1-Wire operations of the non-blocking sequencer, other values write a byte
+#define OW_OP_RESET 0x100
+#define OW_OP_READ 0x200
+
+// return values of OWStep
+#define OW_STEP_FAIL -1
+#define OW_STEP_BUSY 0
+#define OW_STEP_NEXT 1
+#define OW_STEP_DONE 2
+
+// return value of DS18B20Poll while no temperature is available
+#define OW_PENDING -2
+
 typedef struct {
-	int fd;
+	t_i2cdev dev;
 	unsigned char address;
+	uint8_t bus;
 	unsigned long int owDeviceAddress[2]; // should init to 0
 	int owTriplet; // Should be init to 4
 	int owLastDevice; // should init to 0
@@ -46,6 +64,7 @@ typedef struct {
 	char temp_valid;
 	char humidity_valid;
 	char sensor_type;
+	uint64_t serial;		// serial number if the sensor has one, else 0
 	int conversion_time;
 	int delta_conversion_time;
 	int databits;
@@ -54,6 +73,17 @@ typedef struct {
 	int rollover;
 	int maxrollover;
 	int compensate;
+	// non-blocking 1-Wire sequencer
+	const int *ow_ops;
+	int ow_nops;
+	int ow_op;
+	int ow_phase;
+	int ow_polls;
+	int ow_job;
+	int ow_nread;
+	int ow_data[9];
+	// step of the humidity driver
+	int hum_step;
 } t_ds2482;
 
 int ds2482_open(t_ds2482 *, unsigned char);
@@ -68,3 +98,7 @@ int AddCRC(int, int);
 int OWSelect(t_ds2482 *);
 int OWConfigureBits (t_ds2482 *);
 int OWReadTemperature(t_ds2482 *);
+void OWStart(t_ds2482 *, const int *, int);
+int OWStep(t_ds2482 *);
+void DS18B20StartConversion(t_ds2482 *);
+int DS18B20Poll(t_ds2482 *);
@@ -0,0 +1,180 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "hist.h"
+
+#include <stdint.h>
+#include <string.h>
+
+void hist_init(t_hist *h, const char *name)
+{
+	memset(h, 0, sizeof(*h));
+	h->name = name;
+}
+
+// move to the window of now, clearing the windows which were skipped
+static void hist_rotate(t_hist *h, const struct timespec *now)
+{
+	long window = now->tv_sec / HIST_WINDOW_SEC;
+	long n;
+
+	for (n = 0; (h->window < window) && (n < HIST_WINDOWS); n++) {
+		h->window++;
+		h->slot = (h->slot + 1) % HIST_WINDOWS;
+		memset(h->count[h->slot], 0, sizeof(h->count[h->slot]));
+		h->max[h->slot] = 0;
+	}
+	h->window = window;
+}
+
+/**
+* @brief Count a duration
+* @param h pointer to histogram
+* @param now CLOCK_MONOTONIC
+* @param us duration in us
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void hist_add(t_hist *h, const struct timespec *now, float us)
+{
+	int i;
+
+	if (now->tv_sec / HIST_WINDOW_SEC != h->window)
+		hist_rotate(h, now);
+
+	for (i = 0; (i < HIST_BUCKETS - 1) && (us >= (float)(1L << i)); i++);
+	h->count[h->slot][i]++;
+	if (us > h->max[h->slot]) h->max[h->slot] = us;
+}
+
+/**
+* @brief Print the histogram of the last HIST_WINDOWS windows
+* @param h pointer to histogram
+* @param now CLOCK_MONOTONIC
+* @param fp
+* @return
+*
+* Percentiles are given as the upper bound of their bucket.
+*
+* @date 18.10.2026 born
+*
+*/
+void hist_print(t_hist *h, const struct timespec *now, FILE *fp)
+{
+	static const int pct[] = { 50, 90, 99 };
+	unsigned long sum[HIST_BUCKETS];
+	unsigned long total = 0, n;
+	float max = 0;
+	int i, j, k;
+
+	hist_rotate(h, now);
+
+	for (i = 0; i < HIST_BUCKETS; i++) {
+		sum[i] = 0;
+		for (j = 0; j < HIST_WINDOWS; j++)
+			sum[i] += h->count[j][i];
+		total += sum[i];
+	}
+	for (j = 0; j < HIST_WINDOWS; j++)
+		if (h->max[j] > max) max = h->max[j];
+
+	fprintf(fp, "%s: %lu in %d s", h->name, total, HIST_WINDOWS * HIST_WINDOW_SEC);
+	if (total == 0) {
+		fprintf(fp, "\n");
+		return;
+	}
+
+	for (k = 0; k < 3; k++) {
+		for (i = 0, n = 0; i < HIST_BUCKETS - 1; i++) {
+			n += sum[i];
+			if (n * 100 >= total * pct[k]) break;
+		}
+		fprintf(fp, ", p%d < %ld us", pct[k], 1L << i);
+	}
+	fprintf(fp, ", max %.0f us\n", max);
+
+	for (i = 0; i < HIST_BUCKETS; i++)
+		if (sum[i])
+			fprintf(fp, "  %s %8ld us %lu\n", (i < HIST_BUCKETS - 1) ? "<" : ">=", 1L << ((i < HIST_BUCKETS - 1) ? i : i - 1), sum[i]);
+}
+
+// lower bound of a bucket of a log-linear histogram in us
+static unsigned long loghist_lower(int i)
+{
+	int k;
+
+	if (i < 8)
+		return i;
+	k = 3 + (i - 8) / 4;
+	return (unsigned long)(4 + (i - 8) % 4) << (k - 2);
+}
+
+/**
+* @brief Count a duration in a log-linear histogram
+* @param h pointer to histogram
+* @param us duration in us
+* @return
+*
+* Constant time, no floating point math besides the conversion.
+*
+* @date 18.10.2026 born
+*
+*/
+void loghist_add(t_loghist *h, float us)
+{
+	uint64_t v = (us > 0) ? (uint64_t)us : 0;
+	int i, k;
+
+	// 64 bit on the 32 bit target too, where unsigned long is 32 bit
+	if (v < 8)
+		i = v;
+	else {
+		k = 63 - __builtin_clzll(v);
+		i = 8 + (k - 3) * 4 + ((v >> (k - 2)) & 3);
+		if (i >= LOGHIST_BUCKETS) i = LOGHIST_BUCKETS - 1;
+	}
+	h->count[i]++;
+	h->total++;
+	if (us > h->max) h->max = us;
+}
+
+/**
+* @brief Estimate a percentile
+* @param h pointer to histogram
+* @param permille percentile in 1/1000
+* @return upper bound of the bucket holding the percentile in us, max for the last bucket
+*
+* @date 18.10.2026 born
+*
+*/
+float loghist_percentile(const t_loghist *h, int permille)
+{
+	unsigned long n = 0;
+	int i;
+
+	for (i = 0; i < LOGHIST_BUCKETS - 1; i++) {
+		n += h->count[i];
+		if (n * 1000 >= h->total * permille)
+			return loghist_lower(i + 1);
+	}
+	return h->max;
+}
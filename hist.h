@@ -0,0 +1,56 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdio.h>
+#include <time.h>
+
+// bucket i counts values below 2^i us, the last one everything above
+#define HIST_BUCKETS 24
+
+// the histogram covers the last HIST_WINDOWS * HIST_WINDOW_SEC seconds
+#define HIST_WINDOWS 6
+#define HIST_WINDOW_SEC 10
+
+// rolling log2 histogram of durations
+typedef struct {
+	const char *name;
+	long window;			// number of the current window since boot
+	int slot;			// slot of the current window
+	unsigned long count[HIST_WINDOWS][HIST_BUCKETS];
+	float max[HIST_WINDOWS];	// in us
+} t_hist;
+
+// log-linear histogram, exact below 8 us, then 4 buckets per power of two
+// up to 2^17 us, the last bucket counts everything above
+#define LOGHIST_BUCKETS 65
+
+typedef struct {
+	unsigned long total;
+	unsigned int count[LOGHIST_BUCKETS];
+	float max;			// in us
+} t_loghist;
+
+void hist_init(t_hist *, const char *);
+void hist_add(t_hist *, const struct timespec *, float);
+void hist_print(t_hist *, const struct timespec *, FILE *);
+void loghist_add(t_loghist *, float);
+float loghist_percentile(const t_loghist *, int);
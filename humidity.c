@@ -2,16 +2,11 @@
 #include "log.h"
 
 #include <stdio.h>
-#include <sys/ioctl.h>
-#include <fcntl.h>
-#include <linux/i2c-dev.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <errno.h>
 #include <string.h>
-#include <time.h>
 
-#define I2C_DEVICE "/dev/i2c-1"
 
 int si7021_crc_check(unsigned int value, uint8_t crc)
 {
@@ -35,42 +30,72 @@ int si7021_crc_check(unsigned int value, uint8_t crc)
 	return 1 ;
 }
 
-int sht4x_open (t_ds2482 *sensor, unsigned char i2c_address) {
-
-	uint8_t data[6]={0x94,0x89,0,0,0,0};
-
-	sensor->fd = open(I2C_DEVICE, O_RDWR);
-	if (sensor->fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-	if (ioctl(sensor->fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+// The drivers never sleep. Every function which needs the sensor to settle
+// or convert returns HUM_PENDING together with the time to wait before the
+// next step. The caller schedules the next step, at startup that is a plain
+// sleep, while running it is a one-shot timer of the reactor.
+
+/**
+* @brief Register a SHT4x/SHT85 and issue a soft reset
+* @param sensor pointer to sensor instance
+* @param i2c_address
+* @param wait_us time to wait before sht4x_identify()
+* @return HUM_PENDING or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int sht4x_reset (t_ds2482 *sensor, unsigned char i2c_address, long *wait_us) {
+
+	uint8_t data[1]={0x94};
+
+	if (i2cbus_open(&sensor->dev, "SHT4x", sensor->bus, i2c_address) != 0)
 		return 1;
-	}
 
-	if (write(sensor->fd,data,1)!=1) return 2;                                    // Do SHT4x soft reset
-	struct timespec nstime = {0,15e6};
-	while (nanosleep (&nstime,&nstime)) ;                                           // Wait 15 microseconds after reset
-	if (write(sensor->fd,data+2,1)!=1) return 2;                                    // Request Serial Number
-	if (read(sensor->fd,data,6)!=6) {
-		sensor->sensor_type=SHT4X;
-		if (si7021_crc_check((data[0]<<8)|(data[1]),data[2])!=0) return 4;
-		if (si7021_crc_check((data[3]<<8)|(data[4]),data[5])!=0) return 4;
-		fprintf(stderr, "SHT4x, Serial Number: 0x%x%x%x%x - ",data[0],data[1],data[3],data[4]);
+	if (i2cbus_write(&sensor->dev, data,1)!=1) return 2;                                    // Do SHT4x soft reset
+	sensor->hum_step = 0;
+	*wait_us = HUM_RESET_US;
+	return HUM_PENDING;
+}
+
+/**
+* @brief Identify a SHT4x/SHT85 after its reset
+* @param sensor pointer to sensor instance
+* @param wait_us time to wait before calling again
+* @return 0 if identified, HUM_PENDING if another step is due, or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int sht4x_identify (t_ds2482 *sensor, long *wait_us) {
+
+	uint8_t data[6]={0x89,0,0,0,0,0};
+
+	if (sensor->hum_step == 0) {
+		if (i2cbus_write(&sensor->dev, data,1)!=1) return 2;                                    // Request Serial Number
+		if (i2cbus_read(&sensor->dev, data,6)!=6) {
+			sensor->sensor_type=SHT4X;
+			if (si7021_crc_check((data[0]<<8)|(data[1]),data[2])!=0) return 4;
+			if (si7021_crc_check((data[3]<<8)|(data[4]),data[5])!=0) return 4;
+			sensor->serial=((uint32_t)data[0]<<24)|(data[1]<<16)|(data[3]<<8)|data[4];
+			fprintf(stderr, "SHT4x, Serial Number: 0x%x%x%x%x - ",data[0],data[1],data[3],data[4]);
+		} else {
+			data[0]=0x30;
+			data[1]=0xa2;
+			if (i2cbus_write(&sensor->dev, data,2)!=2) return 2;                                    // Do SHT85 soft reset
+			sensor->hum_step = 1;
+			*wait_us = HUM_RESET_US;
+			return HUM_PENDING;
+		}
 	} else {
-		data[0]=0x30;
-		data[1]=0xa2;
-		data[2]=0x36;
-		data[3]=0x82;
-		if (write(sensor->fd,data,2)!=2) return 2;                                    // Do SHT4x soft reset
-		nstime.tv_nsec=15e6;
-		while (nanosleep (&nstime,&nstime)) ;                                           // Wait 15 microseconds after reset
-		if (write(sensor->fd,data+2,2)!=2) return 2;                                    // Request Serial Number
-		if (read(sensor->fd,data,6)!=6) {
+		data[0]=0x36;
+		data[1]=0x82;
+		if (i2cbus_write(&sensor->dev, data,2)!=2) return 2;                                    // Request Serial Number
+		if (i2cbus_read(&sensor->dev, data,6)!=6) {
 			sensor->sensor_type=SHT85;
 			if (si7021_crc_check((data[0]<<8)|(data[1]),data[2])!=0) return 5;
 			if (si7021_crc_check((data[3]<<8)|(data[4]),data[5])!=0) return 5;
+			sensor->serial=((uint32_t)data[0]<<24)|(data[1]<<16)|(data[3]<<8)|data[4];
 			fprintf(stderr, "SHT85, Serial Number: 0x%x%x%x%x - ",data[0],data[1],data[3],data[4]);
 		} else return 3;
 	}
@@ -81,38 +106,61 @@ int sht4x_open (t_ds2482 *sensor, unsigned char i2c_address) {
 		else
 			fprintf(stderr, "Opened SHT85\n");
 	}
-	sensor->address = i2c_address;
+	sensor->address = sensor->dev.address;
 	return (0);
 }
 
+/**
+* @brief Register a HTU31D/HTU21D/SI7021 and issue a soft reset
+* @param sensor pointer to sensor instance
+* @param i2c_address
+* @param wait_us time to wait before si7021_identify()
+* @return HUM_PENDING or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int si7021_reset (t_ds2482 *sensor, unsigned char i2c_address, long *wait_us) {
+
+	uint8_t data[2]={0x1e,0xfe};
+
+	if (i2cbus_open(&sensor->dev, "SI7021", sensor->bus, i2c_address) != 0)
+		return 1;
+
+	if (i2cbus_write(&sensor->dev, data,1)!=1) {                                    // Do HTU31D soft reset
+		sensor->hum_step = 0;
+	} else {
+		if (i2cbus_write(&sensor->dev, data+1,1)<0) return 2;				// Do soft reset for HTU21D/Si7021
+		sensor->hum_step = 1;
+	}
+	*wait_us = HUM_RESET_US;
+	return HUM_PENDING;
+}
 
-int si7021_open (t_ds2482 *sensor, unsigned char i2c_address) {
+/**
+* @brief Identify and configure a HTU31D/HTU21D/SI7021 after its reset
+* @param sensor pointer to sensor instance
+* @param wait_us time to wait before calling again
+* @return 0 if identified, HUM_PENDING if another step is due, or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int si7021_identify (t_ds2482 *sensor, long *wait_us) {
 
 	int sernuma, sernumb;
 	uint8_t i;
 
-	sensor->fd = open(I2C_DEVICE, O_RDWR);
-	if (sensor->fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-	if (ioctl(sensor->fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
-		return 1;
-	}
-
 	uint8_t data[8]={0xfe,0xe6,131,0,0xe7,0x1e,0x08,0x0a};
 	uint8_t data2[4]={0xfa,0x0f,0xfc,0xc9};
 
-	if (write(sensor->fd,data+5,1)!=1) {                                    // Do HTU31D soft reset
-		struct timespec nstime = {0,15e6};
-		while (nanosleep (&nstime,&nstime)) ;                                           // Wait 15 microseconds after reset
-		if (write(sensor->fd,data+6,1)!=1) {					// Request Status byte
-			if (read(sensor->fd,data+6,1)==1) {
+	if (sensor->hum_step == 0) {
+		if (i2cbus_write(&sensor->dev, data+6,1)!=1) {					// Request Status byte
+			if (i2cbus_read(&sensor->dev, data+6,1)==1) {
 				fprintf(stderr, "In4\n");
 				if (data[6]!=0) return 3;						// Confirm status is good
-				if (write(sensor->fd,data+7,1)!=1) return 3;				// Request Serial Number
-				if (read(sensor->fd,data2,4)!=4) return 3;				// Read Serial Number
+				if (i2cbus_write(&sensor->dev, data+7,1)!=1) return 3;				// Request Serial Number
+				if (i2cbus_read(&sensor->dev, data2,4)!=4) return 3;				// Read Serial Number
 				if (si7021_crc_check((data2[0]<<16)|(data2[1]<<8)|(data2[2]),data2[2])>0) return 4; // Verify CRC on serial number
 				switch (sensor->databits) {                                             // Set proper bit configuration
 					case 11 : sensor->databits=0x40; break;
@@ -121,20 +169,23 @@ int si7021_open (t_ds2482 *sensor, unsigned char i2c_address) {
 					case 14 :
 					default : sensor->databits=0x5e; break;
 				}
+				sensor->serial=(data2[0]<<16)|(data2[1]<<8)|data2[2];
 				fprintf(stderr, "HTU31D, Serial Number 0x%x%x%x - ",data[0],data[1],data[2]);
 				sensor->sensor_type=HTU31D;
-				if (g_debug > 0) fprintf(stderr, "Opened HTU31D on 0x%x\n", i2c_address);         // Debug info
-				sensor->address = i2c_address;
+				if (g_debug > 0) fprintf(stderr, "Opened HTU31D on 0x%x\n", sensor->dev.address);         // Debug info
+				sensor->address = sensor->dev.address;
 				return 0;
 			}
 		}
+		if (i2cbus_write(&sensor->dev, data,1)<0) return 2;				// Do soft reset for HTU21D/Si7021
+		sensor->hum_step = 1;
+		*wait_us = HUM_RESET_US;
+		return HUM_PENDING;
 	}
-	if (write(sensor->fd,data,1)<0) return 2;					// Do soft reset for HTU21D/Si7021
-	struct timespec nstime = {0,15e6};
-	while (nanosleep (&nstime,&nstime)) ;						// Wait 15 microseconds after reset
-	if (write(sensor->fd,data+1,2)<0) return 2;					// Program for 11 bits
-	if (write(sensor->fd,data+4,1)<0) return 2;					// Initiate readback configuration
-	if (read (sensor->fd,data+3,1)<0) return 3;					// Readback configuration
+
+	if (i2cbus_write(&sensor->dev, data+1,2)<0) return 2;					// Program for 11 bits
+	if (i2cbus_write(&sensor->dev, data+4,1)<0) return 2;					// Initiate readback configuration
+	if (i2cbus_read(&sensor->dev, data+3,1)<0) return 3;					// Readback configuration
 	if ((data[2]&129)!=(data[3]&129)) return 3;					// Is it valid?
 
 	switch (sensor->databits) {							// Set proper bit configuration
@@ -144,24 +195,25 @@ int si7021_open (t_ds2482 *sensor, unsigned char i2c_address) {
 		case 14 :
 		default : data[2] = 2;   break;
 	}
-	if (write(sensor->fd,data+1,2)<0) return 4;					// Program proper bit configuration
-	if (write(sensor->fd,data+4,1)<0) return 4;					// Initiate readback configuration
-	if (read(sensor->fd,data+3,1)<0) return 4;					// Read back configuration
+	if (i2cbus_write(&sensor->dev, data+1,2)<0) return 4;					// Program proper bit configuration
+	if (i2cbus_write(&sensor->dev, data+4,1)<0) return 4;					// Initiate readback configuration
+	if (i2cbus_read(&sensor->dev, data+3,1)<0) return 4;					// Read back configuration
 	if ((data[2]&129)!=(data[3]&129)) return 4; 					// Is it valid?
-	if (write(sensor->fd,data2,2)<0) return 4;					// Initiate Serial Number A readback
-	if (read (sensor->fd,data,8)<0) return 4;					// Readback Serial Number A
+	if (i2cbus_write(&sensor->dev, data2,2)<0) return 4;					// Initiate Serial Number A readback
+	if (i2cbus_read(&sensor->dev, data,8)<0) return 4;					// Readback Serial Number A
 	for (i=sernuma=0 ; i<8 ; i+=2) {
 		if (si7021_crc_check(data[i],data[i+1])==1) return 4;			// Check for valid CRC
 		sernuma=(sernuma<<8)|(data[i]);
 	}
 
-	if (write(sensor->fd,data2+2,2)<0) return 4;					// Initiate Serial Number B readback
-	if (read (sensor->fd,data,6)<0) return 4;					// Readback Serial Number B
+	if (i2cbus_write(&sensor->dev, data2+2,2)<0) return 4;					// Initiate Serial Number B readback
+	if (i2cbus_read(&sensor->dev, data,6)<0) return 4;					// Readback Serial Number B
 	for (i=sernumb=0 ; i<6 ; i+=3) {
 		if (si7021_crc_check((data[i]<<8)|(data[i+1]),data[i+2])==1) return 4;	// Check for valid CRC
 		sernumb=(sernumb<<16)|(data[i]<<8)|(data[i+1]);				// Concatenate Serial Number B
 	}
 
+	sensor->serial=((uint64_t)(uint32_t)sernuma<<32)|(uint32_t)sernumb;
 	switch (data[0]) {								// Display Serial number and set sensor type
 		case 0x00 :
 		case 0xff : sensor->sensor_type=SI7021;
@@ -182,8 +234,8 @@ int si7021_open (t_ds2482 *sensor, unsigned char i2c_address) {
 	if (sensor->sensor_type==SI7021) {						// If it's a SI7021 get the firmware revision
 		data[0]=0x84;
 		data[1]=0xb8;
-		if (write(sensor->fd,data,2)<0) return 4;
-		if (read(sensor->fd,data,1)<0) return 4;
+		if (i2cbus_write(&sensor->dev, data,2)<0) return 4;
+		if (i2cbus_read(&sensor->dev, data,1)<0) return 4;
 		switch (data[0]) {
 			case 0xff : fprintf(stderr, "Firmware revision 1.0 - "); break;
 			case 0x20 : fprintf(stderr, "Firmware revision 2.0 - "); break;
@@ -192,13 +244,37 @@ int si7021_open (t_ds2482 *sensor, unsigned char i2c_address) {
 	}
 
 	if (g_debug > 0) {
-		if (sensor->sensor_type==SI7021) fprintf(stderr, "Opened SI7021/HTU21D on 0x%x\n", i2c_address);		// Debug info
-		else fprintf(stderr, "Opened HTU21D on 0x%x\n",i2c_address);
+		if (sensor->sensor_type==SI7021) fprintf(stderr, "Opened SI7021/HTU21D on 0x%x\n", sensor->dev.address);		// Debug info
+		else fprintf(stderr, "Opened HTU21D on 0x%x\n",sensor->dev.address);
 	}
-	sensor->address = i2c_address;
+	sensor->address = sensor->dev.address;
 	return (0);
 }
 
+/**
+* @brief Upper bound of the conversion time of a humidity sensor
+* @param sensor pointer to sensor instance
+* @param temp for HTU21D the temperature conversion, otherwise humidity
+* @return conversion time in us
+*
+* Taken from the data sheets for the highest resolution.
+*
+* @date 18.10.2026 born
+*
+*/
+long humidity_conversion_time (t_ds2482 *sensor, int temp) {
+
+	switch (sensor->sensor_type) {
+		case HTU21D : return temp ? HTU21D_TEMP_US : HTU21D_HUMIDITY_US;
+		case HTU31D : return HTU31D_CONVERSION_US;
+		case SI7021 : return SI7021_CONVERSION_US;
+		case SHT4X  : return SHT4X_CONVERSION_US;
+		case SHT85  : return SHT85_CONVERSION_US;
+		case AM2321 : return AM2321_CONVERSION_US;
+	}
+	return 0;
+}
+
 int si7021_start_humidity (t_ds2482 *sensor) {
 	char config[2],lngth=1;
 
@@ -210,7 +286,7 @@ int si7021_start_humidity (t_ds2482 *sensor) {
 		case SHT85  : config[0] = 0x24; config[1] = 0x00; lngth=2; break;
 		default     : return 2;
 	}
-	if (write(sensor->fd, &config, lngth)!=lngth) return 1;
+	if (i2cbus_write(&sensor->dev, &config, lngth)!=lngth) return 1;
 	return 0;
 }
 
@@ -227,7 +303,7 @@ int si7021_start_temp (t_ds2482 *sensor) {
 		case SHT85  : config[0]=0x24; config[1]=0x00; lngth=2; break;
 		default     : return 2;
 	}
-	if (write(sensor->fd, &config, lngth)!=lngth) return 1;
+	if (i2cbus_write(&sensor->dev, &config, lngth)!=lngth) return 1;
 	return 0;
 }
 
@@ -239,7 +315,7 @@ int si7021_read_temp (t_ds2482 *sensor) {
 	switch (sensor->sensor_type) {
 		case HTU21D :
 			sensor->temp_valid=0;
-			if (read(sensor->fd, data, 3) != 3) return 4;
+			if (i2cbus_read(&sensor->dev, data, 3) != 3) return 4;
 			if (si7021_crc_check((data[0]<<8)|data[1],data[2])>0) return 2;
 			temp = (double) ((data[0]<<8)|data[1]) * 175.72/65536.0 - 46.85;
 			sensor->temperature = temp;
@@ -258,7 +334,7 @@ int si7021_read_humidity (t_ds2482 *sensor) {
 	if (sensor->sensor_type!=HTU21D) sensor->temp_valid=0;
 	switch (sensor->sensor_type) {
 		case SI7021 : case HTU21D :
-			if (read(sensor->fd, data, 3) != 3) return 4;
+			if (i2cbus_read(&sensor->dev, data, 3) != 3) return 4;
 			if ((x=si7021_crc_check((data[0]<<8)|data[1],data[2]))==0) {
 				temp = (double) ((data[0]<<8)|data[1]) * 125/65536.0 - 6;
 				if (sensor->compensate) temp += (25-sensor->temperature) * -0.15;
@@ -267,8 +343,8 @@ int si7021_read_humidity (t_ds2482 *sensor) {
 			}
 			if (sensor->sensor_type==HTU21D) return x;
 			data[0]=0xe0;
-			if (write(sensor->fd,data, 1) != 1) return 4;
-			if (read(sensor->fd, data, 3) != 3) return 4;
+			if (i2cbus_write(&sensor->dev, data, 1) != 1) return 4;
+			if (i2cbus_read(&sensor->dev, data, 3) != 3) return 4;
 			if ((y=si7021_crc_check((data[0]<<8)|data[1],data[2]))==0) {
 				sensor->temperature = (double) ((data[0]<<8)|data[1]) * 175.72/65536.0 - 46.85;
 				sensor->temp_valid = sensor->temp_present;
@@ -277,9 +353,9 @@ int si7021_read_humidity (t_ds2482 *sensor) {
 			break;
 		case HTU31D :
 			data[0]=0x0;
-			if (write(sensor->fd,data, 1) != 1) return 4;
+			if (i2cbus_write(&sensor->dev, data, 1) != 1) return 4;
 		case SHT4X : case SHT85 :
-			if (read(sensor->fd, data, 6) != 6) return 4;
+			if (i2cbus_read(&sensor->dev, data, 6) != 6) return 4;
 			x=si7021_crc_check((data[0]<<8)|data[1],data[2]);
 			y=si7021_crc_check((data[3]<<8)|data[4],data[5]);
 			switch (sensor->sensor_type) {
@@ -310,9 +386,9 @@ int si7021_configure_heater_value (t_ds2482 *sensor, int value)
 
 	if (sensor->sensor_type==SI7021) {
 		data[1]=value&0xf;				// If SI7021 initialize the heat control register
-		if (write(sensor->fd,data,2)!=2) return 2;	// Program it
-		if (write(sensor->fd,data+2,1)!=1) return 2;    // Start readback
-		if (read(sensor->fd,data,1)!=1) return 2;	// Readback
+		if (i2cbus_write(&sensor->dev, data,2)!=2) return 2;	// Program it
+		if (i2cbus_write(&sensor->dev, data+2,1)!=1) return 2;    // Start readback
+		if (i2cbus_read(&sensor->dev, data,1)!=1) return 2;	// Readback
 		if (data[1]!=(value&0xf)) return 2;		// Verify readback matches written value
 	} else return 1;
 	return 0;
@@ -327,32 +403,32 @@ int si7021_configure_heater_onoff (t_ds2482 *sensor, int value)
 	switch (sensor->sensor_type) {
 		case HTU31D:
 			if (value==1) data[2]=4; else data[2]=2;
-			if (write(sensor->fd,data+2,2)!=2) return 2;
-			if (read(sensor->fd,data,1)!=1) return 3;
+			if (i2cbus_write(&sensor->dev, data+2,2)!=2) return 2;
+			if (i2cbus_read(&sensor->dev, data,1)!=1) return 3;
 			if ((data[0]&1)!=(value&1)) return 4;
 			break;
 		case HTU21D : case SI7021 :
-			if (write(sensor->fd,data,1)!=1) return 2;		// Start read user register 1
-			if (read(sensor->fd,data+2,1)!=1) return 2;		// Read user register 1
+			if (i2cbus_write(&sensor->dev, data,1)!=1) return 2;		// Start read user register 1
+			if (i2cbus_read(&sensor->dev, data+2,1)!=1) return 2;		// Read user register 1
 			if (value==1) data[2]|=4; else data[2]&=0xfb;		// Set heater value as desired
 			data[3]=0xe7;
 			data[0]=data[2];
-			if (write(sensor->fd,data+1,2)!=2) return 3;		// Program it
-			if (write(sensor->fd,data+3,1)!=1) return 3;		// Start readback
-			if (read(sensor->fd,data+2,1)!=1) return 3;		// Readback
+			if (i2cbus_write(&sensor->dev, data+1,2)!=2) return 3;		// Program it
+			if (i2cbus_write(&sensor->dev, data+3,1)!=1) return 3;		// Start readback
+			if (i2cbus_read(&sensor->dev, data+2,1)!=1) return 3;		// Readback
 			if (data[2]!=data[0]) return 4;				// Verify Readback matches written value
 			break;
 		case SHT4X :
 			data[0]=0x39;
-			if (write(sensor->fd,data,1)!=1) return 2;
+			if (i2cbus_write(&sensor->dev, data,1)!=1) return 2;
 			break;
 		case SHT85 :
 			data[0]=0x30;
 			data[2]=0xf2;
 			data[3]=0x3d;
 			if (value==1) data[1]=0x6d; else data[1]=0x66;
-			if (write(sensor->fd,data,4)!=4) return 2;
-			if (read(sensor->fd,data,3)!=3) return 3;
+			if (i2cbus_write(&sensor->dev, data,4)!=4) return 2;
+			if (i2cbus_read(&sensor->dev, data,3)!=3) return 3;
 			if (((data[0]>>5)&1)!=value) return 4;
 			if (si7021_crc_check((data[0]<<8)|data[1],data[2])==1) return 5;
 	}
@@ -374,55 +450,26 @@ static uint16_t _combine_bytes(uint8_t msb, uint8_t lsb) {
 	return ((uint16_t)msb << 8) | (uint16_t)lsb;
 }
 
-int am2321_open (t_ds2482 *sensor, unsigned char i2c_address) {
-
-	sensor->fd = open(I2C_DEVICE, O_RDWR);
-	if (sensor->fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-	if (ioctl(sensor->fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (am2321_read(sensor)>0) return 1;
-	if (g_debug > 0) fprintf(stderr, "Opened AM2321 on 0x%x\n", i2c_address);
-
-	// assign file handle to sensor object
-	sensor->address = i2c_address;
-	return (0);
-}
-
-int am2321_wakeup (t_ds2482 *sensor) {
-
-	//  wake AM2320 up, goes to sleep to not warm up and affect the humidity sensor
-
-	if (write(sensor->fd, NULL, 0)<0) return 3;
-	struct timespec nstime = {0,1.0e6};
-	while (nanosleep (&nstime,&nstime)) ; /* Wait atleast 1.5ms */
-	return 0;
-}
-
-int am2321_read (t_ds2482 *sensor) {
+static int am2321_step (t_ds2482 *sensor, long *wait_us) {
 	uint8_t data[8];
 
-	data[0] = 0x00;
-	if (write(sensor->fd, NULL, 0)<0)
-	return 3;
-
-	struct timespec nstime = {0,1.0e6};
-	while (nanosleep (&nstime,&nstime)) ; /* Wait atleast 1.5ms */
-
-	/* write at addr 0x03, start reg = 0x00, num regs = 0x04 */
-	data[0] = 0x03;
-	data[1] = 0x00;
-	data[2] = 0x04;
-	if (write(sensor->fd, data, 3) < 0) return 3;
-
-	/* wait for AM2320 */
-	nstime.tv_nsec = 1.6e6;
-	while (nanosleep (&nstime,&nstime)) ; /* Wait atleast 1.5ms */
+	switch (sensor->hum_step++) {
+		case 0 :
+			//  wake AM2320 up, goes to sleep to not warm up and affect the humidity sensor
+			if (i2cbus_write(&sensor->dev, NULL, 0)<0) return 3;
+			*wait_us = AM2321_WAKEUP_US;
+			return HUM_PENDING;
+		case 1 :
+			/* write at addr 0x03, start reg = 0x00, num regs = 0x04 */
+			data[0] = 0x03;
+			data[1] = 0x00;
+			data[2] = 0x04;
+			if (i2cbus_write(&sensor->dev, data, 3) < 0) return 3;
+
+			/* wait for AM2320 */
+			*wait_us = AM2321_CONVERSION_US;
+			return HUM_PENDING;
+	}
 
 	/*
 	 * Read out 8 bytes of data
@@ -436,7 +483,7 @@ int am2321_read (t_ds2482 *sensor) {
 	 * Byte 7: CRC msb byte
 	*/
 
-  	if (read(sensor->fd, data, 8) < 0) return 4;
+  	if (i2cbus_read(&sensor->dev, data, 8) < 0) return 4;
 
 	/* Check data[0] and data[1] */
 	if (data[0] != 0x03 || data[1] != 0x04) return 9;
@@ -472,4 +519,103 @@ int am2321_read (t_ds2482 *sensor) {
 	return 0;
 }
 
+/**
+* @brief Register an AM2321 and wake it up
+* @param sensor pointer to sensor instance
+* @param i2c_address
+* @param wait_us time to wait before am2321_identify()
+* @return HUM_PENDING or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int am2321_wakeup (t_ds2482 *sensor, unsigned char i2c_address, long *wait_us) {
+
+	if (i2cbus_open(&sensor->dev, "AM2321", sensor->bus, i2c_address) != 0)
+		return 1;
+
+	sensor->hum_step = 0;
+	return am2321_step(sensor, wait_us);
+}
+
+int am2321_identify (t_ds2482 *sensor, long *wait_us) {
+	int result = am2321_step(sensor, wait_us);
+
+	if (result == 0) {
+		if (g_debug > 0) fprintf(stderr, "Opened AM2321 on 0x%x\n", sensor->dev.address);
+		sensor->address = sensor->dev.address;
+	}
+	return result;
+}
+
+/**
+* @brief Start a measurement cycle of a temperature/humidity sensor
+* @param sensor pointer to sensor instance
+* @param wait_us time to wait before humidity_step()
+* @return 0 if the cycle is complete, HUM_PENDING if another step is due,
+*         or an error code
+*
+* @date 18.10.2026 born
+*
+*/
+int humidity_start (t_ds2482 *sensor, long *wait_us) {
+	sensor->hum_step = 0;
+	return humidity_step(sensor, wait_us);
+}
 
+/**
+* @brief Do the next step of a measurement cycle
+* @param sensor pointer to sensor instance
+* @param wait_us time to wait before calling again
+* @return 0 if the cycle is complete, HUM_PENDING if another step is due,
+*         or an error code
+*
+* A cycle starts the conversion and collects the result once the conversion
+* time has passed. The HTU21D converts temperature and humidity one after
+* the other, the other sensors deliver both with one conversion.
+*
+* @date 18.10.2026 born
+*
+*/
+int humidity_step (t_ds2482 *sensor, long *wait_us) {
+
+	switch (sensor->sensor_type) {
+		case AM2321 :
+			return am2321_step(sensor, wait_us);
+		case HTU21D :
+			switch (sensor->hum_step++) {
+				case 0 :
+					if (sensor->temp_present) {
+						if (si7021_start_temp(sensor)) return 1;
+						*wait_us = humidity_conversion_time(sensor, 1);
+						return HUM_PENDING;
+					}
+					sensor->hum_step++;
+					// fallthrough
+				case 1 :
+					if (sensor->temp_present) {
+						si7021_read_temp(sensor);
+						fprintf(stderr, "Temperature: %f\n",sensor->temperature);
+					}
+					if (sensor->temp_valid) sensor->compensate=1; else sensor->compensate=0;
+					if (sensor->humidity_present) {
+						if (si7021_start_humidity(sensor)) return 1;
+						*wait_us = humidity_conversion_time(sensor, 0);
+						return HUM_PENDING;
+					}
+					return 0;
+			}
+			si7021_read_humidity(sensor);
+			fprintf(stderr, "Humidity: %f\n",sensor->humidity);
+			return 0;
+		case HTU31D : case SI7021 : case SHT4X : case SHT85 :
+			if (sensor->hum_step++ == 0) {
+				if (si7021_start_humidity(sensor)) return 1;
+				*wait_us = humidity_conversion_time(sensor, 0);
+				return HUM_PENDING;
+			}
+			si7021_read_humidity(sensor);
+			return 0;
+	}
+	return 2;
+}
@@ -31,16 +31,36 @@
 
 #include <stdint.h>
 
+// returned by the driver steps if another step is due after a wait
+#define HUM_PENDING -1
+
+// wait after a soft reset in us
+#define HUM_RESET_US 15000
+
+// max. conversion times in us at the highest resolution
+#define HTU21D_TEMP_US 50000
+#define HTU21D_HUMIDITY_US 16000
+#define HTU31D_CONVERSION_US 20000
+#define SI7021_CONVERSION_US 23000	// humidity plus temperature
+#define SHT4X_CONVERSION_US 9000
+#define SHT85_CONVERSION_US 16000
+#define AM2321_WAKEUP_US 1000
+#define AM2321_CONVERSION_US 1600
+
 int si7021_crc_check (unsigned int, uint8_t);
-int sht4x_open (t_ds2482 *, unsigned char);
-int si7021_open (t_ds2482 *, unsigned char);
+int sht4x_reset (t_ds2482 *, unsigned char, long *);
+int sht4x_identify (t_ds2482 *, long *);
+int si7021_reset (t_ds2482 *, unsigned char, long *);
+int si7021_identify (t_ds2482 *, long *);
+long humidity_conversion_time (t_ds2482 *, int);
+int humidity_start (t_ds2482 *, long *);
+int humidity_step (t_ds2482 *, long *);
 int si7021_start_humidity (t_ds2482 *);
 int si7021_start_temp (t_ds2482 *);
 int si7021_read_temp (t_ds2482 *);
 int si7021_read_humidity (t_ds2482 *);
 int si7021_configure_heater_value (t_ds2482 *, int);
 int si7021_configure_heater_onoff (t_ds2482 *, int);
-int am2321_open (t_ds2482 *, unsigned char);
-int am2321_read (t_ds2482 *);
-int am2321_wakeup (t_ds2482 *);
+int am2321_wakeup (t_ds2482 *, unsigned char, long *);
+int am2321_identify (t_ds2482 *, long *);
 
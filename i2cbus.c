@@ -0,0 +1,444 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "i2cbus.h"
+#include "clock.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+// The bus manager owns one fd per I2C bus. Devices are addressed per
+// transaction with I2C_RDWR, so no I2C_SLAVE binding is needed and any number
+// of devices share the fd. Messages are queued between i2cbus_begin() and
+// i2cbus_flush() and go out as one transaction with repeated STARTs.
+//
+// The bus lock is held from begin to flush. The acquisition and output
+// threads both use bus 1, so the lock uses priority inheritance to keep the
+// real time acquisition thread from waiting on a preempted output thread.
+
+typedef struct {
+	int fd;
+	int users;
+	pthread_mutex_t lock;
+	struct i2c_msg msgs[I2CBUS_MAX_MSGS];
+	t_i2cdev *owner[I2CBUS_MAX_MSGS];
+	int nmsgs;
+	int overflow;
+} t_i2cbus;
+
+static int kernel_attach(uint8_t bus)
+{
+	char i2c_dev[20];
+	int fd;
+
+	sprintf(i2c_dev, "/dev/i2c-%hhu", bus);
+	fd = open(i2c_dev, O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+		fprintf(stderr, "Error opening %s: %s\n", i2c_dev, strerror(errno));
+	return fd;
+}
+
+static void kernel_detach(int fd)
+{
+	close(fd);
+}
+
+static int kernel_transfer(int fd, struct i2c_msg *msgs, int nmsgs)
+{
+	struct i2c_rdwr_ioctl_data rdwr = { .msgs = msgs, .nmsgs = nmsgs };
+
+	return ioctl(fd, I2C_RDWR, &rdwr);
+}
+
+static const t_i2cbus_backend kernel_backend = {
+	.attach = kernel_attach,
+	.detach = kernel_detach,
+	.transfer = kernel_transfer,
+};
+
+static const t_i2cbus_backend *backend = &kernel_backend;
+static t_i2cbus busses[I2CBUS_MAX_BUSSES];
+static t_i2cdev *devices[I2CBUS_MAX_DEVICES];
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t zero_length;
+
+static int i2cbus_attach(uint8_t bus)
+{
+	t_i2cbus *b = &busses[bus];
+	pthread_mutexattr_t attr;
+
+	if (b->users++ > 0)
+		return 0;
+
+	b->fd = backend->attach(bus);
+	if (b->fd < 0) {
+		b->users = 0;
+		return 1;
+	}
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&b->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	b->nmsgs = 0;
+	b->overflow = 0;
+	return 0;
+}
+
+static void i2cbus_detach(uint8_t bus)
+{
+	t_i2cbus *b = &busses[bus];
+
+	if (--b->users > 0)
+		return;
+
+	backend->detach(b->fd);
+	pthread_mutex_destroy(&b->lock);
+}
+
+/**
+* @brief Replace the kernel driver, e.g. by a simulation
+* @param b transport used for all busses opened from now on
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void i2cbus_set_backend(const t_i2cbus_backend *b)
+{
+	backend = b;
+}
+
+/**
+* @brief Register a device on an I2C bus
+* @param dev pointer to device instance
+* @param name device name used in stats output
+* @param bus I2C bus number
+* @param address 7 bit I2C address
+* @return result
+*
+* The bus is opened by its first device. Opening an already registered
+* device moves it to the new bus and address, this is used by autodetect.
+*
+* @date 18.10.2026 born
+*
+*/
+int i2cbus_open(t_i2cdev *dev, const char *name, uint8_t bus, unsigned char address)
+{
+	int i, slot = -1;
+
+	if (bus >= I2CBUS_MAX_BUSSES) {
+		fprintf(stderr, "I2C bus %hhu not supported\n", bus);
+		return 1;
+	}
+
+	pthread_mutex_lock(&registry_lock);
+	for (i = 0; i < I2CBUS_MAX_DEVICES; i++) {
+		if (devices[i] == dev) {
+			i2cbus_detach(dev->bus);
+			devices[i] = NULL;
+		}
+		if ((devices[i] == NULL) && (slot < 0))
+			slot = i;
+	}
+	if (slot < 0) {
+		pthread_mutex_unlock(&registry_lock);
+		fprintf(stderr, "Too many I2C devices\n");
+		return 1;
+	}
+	if (i2cbus_attach(bus) != 0) {
+		pthread_mutex_unlock(&registry_lock);
+		return 1;
+	}
+
+	memset(dev, 0, sizeof(*dev));
+	dev->name = name;
+	dev->bus = bus;
+	dev->address = address;
+	devices[slot] = dev;
+	pthread_mutex_unlock(&registry_lock);
+	return 0;
+}
+
+void i2cbus_close(t_i2cdev *dev)
+{
+	int i;
+
+	pthread_mutex_lock(&registry_lock);
+	for (i = 0; i < I2CBUS_MAX_DEVICES; i++)
+		if (devices[i] == dev) {
+			i2cbus_detach(dev->bus);
+			devices[i] = NULL;
+		}
+	pthread_mutex_unlock(&registry_lock);
+}
+
+/**
+* @brief Start a transaction, takes the bus lock until i2cbus_flush()
+* @param bus I2C bus number
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void i2cbus_begin(uint8_t bus)
+{
+	t_i2cbus *b = &busses[bus];
+
+	pthread_mutex_lock(&b->lock);
+	b->nmsgs = 0;
+	b->overflow = 0;
+}
+
+static int i2cbus_queue(t_i2cdev *dev, uint16_t flags, void *buf, size_t len)
+{
+	t_i2cbus *b = &busses[dev->bus];
+	struct i2c_msg *msg;
+
+	if ((b->nmsgs == I2CBUS_MAX_MSGS) || (len > UINT16_MAX)) {
+		b->overflow = 1;
+		return 1;
+	}
+
+	msg = &b->msgs[b->nmsgs];
+	msg->addr = dev->address;
+	msg->flags = flags;
+	msg->len = len;
+	msg->buf = (len > 0) ? buf : &zero_length;
+	b->owner[b->nmsgs++] = dev;
+	return 0;
+}
+
+int i2cbus_queue_write(t_i2cdev *dev, const void *buf, size_t len)
+{
+	return i2cbus_queue(dev, 0, (void *)buf, len);
+}
+
+int i2cbus_queue_read(t_i2cdev *dev, void *buf, size_t len)
+{
+	return i2cbus_queue(dev, I2C_M_RD, buf, len);
+}
+
+/**
+* @brief Submit all queued messages as one I2C_RDWR transaction
+* @param bus I2C bus number
+* @return result
+*
+* Releases the bus lock taken by i2cbus_begin(). The duration of the
+* transaction is accounted to every device which took part in it.
+*
+* @date 18.10.2026 born
+*
+*/
+int i2cbus_flush(uint8_t bus)
+{
+	t_i2cbus *b = &busses[bus];
+	struct timespec start, end;
+	int i, j, op, result = 0;
+	float us;
+
+	if (b->overflow) {
+		fprintf(stderr, "I2C transaction on bus %hhu too long\n", bus);
+		result = 1;
+	} else if (b->nmsgs > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (backend->transfer(b->fd, b->msgs, b->nmsgs) != b->nmsgs)
+			result = 1;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		us = timespec_delta_us(&end, &start);
+
+		for (i = 0; i < b->nmsgs; i++) {
+			t_i2cdev *dev = b->owner[i];
+
+			dev->bytes += b->msgs[i].len;
+
+			// count each device once per transaction
+			for (j = 0; j < i; j++)
+				if (b->owner[j] == dev) break;
+			if (j < i) continue;
+
+			// a write followed by a read of the same device is a combined transfer
+			op = (b->msgs[i].flags & I2C_M_RD) ? I2CBUS_OP_READ : I2CBUS_OP_WRITE;
+			for (j = i + 1; (j < b->nmsgs) && (op == I2CBUS_OP_WRITE); j++)
+				if ((b->owner[j] == dev) && (b->msgs[j].flags & I2C_M_RD))
+					op = I2CBUS_OP_XFER;
+
+			dev->transfers++;
+			if (result) {
+				dev->errors++;
+				dev->op_errors[op]++;
+			}
+			dev->busy_us += us;
+			if (us > dev->max_us) dev->max_us = us;
+			loghist_add(&dev->op_hist[op], us);
+		}
+	}
+
+	b->nmsgs = 0;
+	pthread_mutex_unlock(&b->lock);
+	return result;
+}
+
+/**
+* @brief Write to a device in a transaction of its own
+* @param dev pointer to device instance
+* @param buf data
+* @param len number of bytes
+* @return number of bytes written, -1 on error
+*
+* @date 18.10.2026 born
+*
+*/
+ssize_t i2cbus_write(t_i2cdev *dev, const void *buf, size_t len)
+{
+	i2cbus_begin(dev->bus);
+	i2cbus_queue_write(dev, buf, len);
+	if (i2cbus_flush(dev->bus) != 0)
+		return -1;
+	return len;
+}
+
+ssize_t i2cbus_read(t_i2cdev *dev, void *buf, size_t len)
+{
+	i2cbus_begin(dev->bus);
+	i2cbus_queue_read(dev, buf, len);
+	if (i2cbus_flush(dev->bus) != 0)
+		return -1;
+	return len;
+}
+
+// count an operation the driver has to repeat
+void i2cbus_retry(t_i2cdev *dev)
+{
+	t_i2cbus *b = &busses[dev->bus];
+
+	pthread_mutex_lock(&b->lock);
+	dev->retries++;
+	pthread_mutex_unlock(&b->lock);
+}
+
+// Copy the stats of a device under its bus lock, they are updated by the
+// thread which drives the device. With a timeout the copy is given up if
+// the lock is not free in time, e.g. when a signal handler interrupted the
+// thread holding it.
+static int i2cbus_copy_stats(t_i2cdev *dev, t_i2cdev *copy, long timeout_us)
+{
+	t_i2cbus *b = &busses[dev->bus];
+	struct timespec deadline;
+
+	if (timeout_us > 0) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		timespec_add_us(&deadline, timeout_us);
+		if (pthread_mutex_timedlock(&b->lock, &deadline) != 0)
+			return 1;
+	} else {
+		pthread_mutex_lock(&b->lock);
+	}
+	*copy = *dev;
+	pthread_mutex_unlock(&b->lock);
+	return 0;
+}
+
+void i2cbus_print_stats(FILE *fp)
+{
+	static const char *op_names[I2CBUS_OPS] = { "write", "read", "xfer" };
+	t_i2cdev stats, *dev = &stats;
+	int i, op;
+
+	// called from signal handlers, the registry only changes during startup
+	for (i = 0; i < I2CBUS_MAX_DEVICES; i++) {
+		if (devices[i] == NULL)
+			continue;
+		if (i2cbus_copy_stats(devices[i], &stats, 10000) != 0) {
+			fprintf(fp, "I2C %s @ %hhu:0x%x: bus busy\n", devices[i]->name, devices[i]->bus, devices[i]->address);
+			continue;
+		}
+		fprintf(fp, "I2C %s @ %hhu:0x%x: %lu transfers, %lu errors, %lu retries, %lu bytes, %.1fus avg, %.1fus max\n",
+			dev->name, dev->bus, dev->address, dev->transfers, dev->errors, dev->retries, dev->bytes,
+			dev->transfers ? dev->busy_us / dev->transfers : 0.0, dev->max_us);
+
+		for (op = 0; op < I2CBUS_OPS; op++) {
+			const t_loghist *h = &dev->op_hist[op];
+
+			if (h->total == 0)
+				continue;
+			fprintf(fp, "  %-5s %lu, %lu errors, p50 < %.0fus, p90 < %.0fus, p99 < %.0fus, p99.9 < %.0fus, max %.0fus\n",
+				op_names[op], h->total, dev->op_errors[op], loghist_percentile(h, 500), loghist_percentile(h, 900),
+				loghist_percentile(h, 990), loghist_percentile(h, 999), h->max);
+		}
+	}
+}
+
+/**
+* @brief Write the device stats in the Prometheus text exposition format
+* @param fp
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void i2cbus_write_metrics(FILE *fp)
+{
+	static const char *op_names[I2CBUS_OPS] = { "write", "read", "xfer" };
+	static const struct {
+		const char *name;
+		const char *help;
+	} families[] = {
+		{ "i2c_transfers_total", "I2C transactions per device." },
+		{ "i2c_errors_total", "Failed I2C transactions per device." },
+		{ "i2c_retries_total", "Operations repeated by the driver per device." },
+		{ "i2c_latency_p99_us", "99th percentile of the transaction duration per operation in us." },
+	};
+	t_i2cdev stats[I2CBUS_MAX_DEVICES];
+	int f, i, op;
+
+	// one consistent copy of each device for all families
+	for (i = 0; i < I2CBUS_MAX_DEVICES; i++)
+		if (devices[i] != NULL)
+			i2cbus_copy_stats(devices[i], &stats[i], 0);
+
+	for (f = 0; f < 4; f++) {
+		fprintf(fp, "# HELP sensord_%s %s\n# TYPE sensord_%s %s\n", families[f].name, families[f].help,
+			families[f].name, (f < 3) ? "counter" : "gauge");
+
+		for (i = 0; i < I2CBUS_MAX_DEVICES; i++) {
+			t_i2cdev *dev = &stats[i];
+
+			if (devices[i] == NULL)
+				continue;
+			if (f < 3) {
+				fprintf(fp, "sensord_%s{device=\"%s\",bus=\"%hhu\",address=\"0x%02x\"} %lu\n", families[f].name,
+					dev->name, dev->bus, dev->address, (f == 0) ? dev->transfers : (f == 1) ? dev->errors : dev->retries);
+				continue;
+			}
+			for (op = 0; op < I2CBUS_OPS; op++)
+				if (dev->op_hist[op].total)
+					fprintf(fp, "sensord_%s{device=\"%s\",bus=\"%hhu\",address=\"0x%02x\",op=\"%s\"} %.0f\n", families[f].name,
+						dev->name, dev->bus, dev->address, op_names[op], loghist_percentile(&dev->op_hist[op], 990));
+		}
+	}
+}
@@ -0,0 +1,77 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "hist.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <linux/i2c.h>
+
+#define I2CBUS_MAX_BUSSES 8
+#define I2CBUS_MAX_DEVICES 16
+#define I2CBUS_MAX_MSGS 16
+
+// operations of a device in a transaction
+#define I2CBUS_OP_WRITE 0
+#define I2CBUS_OP_READ 1
+#define I2CBUS_OP_XFER 2		// write followed by read
+#define I2CBUS_OPS 3
+
+// device on a shared I2C bus, addressed per transaction
+typedef struct {
+	const char *name;
+	uint8_t bus;
+	unsigned char address;
+	// timing stats of the transactions the device took part in
+	unsigned long transfers;
+	unsigned long errors;
+	unsigned long bytes;
+	double busy_us;
+	float max_us;
+	unsigned long retries;		// operations repeated by the driver, e.g. busy polls
+	unsigned long op_errors[I2CBUS_OPS];
+	t_loghist op_hist[I2CBUS_OPS];	// transaction duration per operation
+} t_i2cdev;
+
+// Transport of the busses, the kernel i2c-dev driver unless a simulation
+// is installed. transfer() returns the number of messages done, -1 if a
+// message was not acknowledged.
+typedef struct {
+	int (*attach)(uint8_t bus);
+	void (*detach)(int fd);
+	int (*transfer)(int fd, struct i2c_msg *msgs, int nmsgs);
+} t_i2cbus_backend;
+
+void i2cbus_set_backend(const t_i2cbus_backend *);
+int i2cbus_open(t_i2cdev *, const char *, uint8_t, unsigned char);
+void i2cbus_close(t_i2cdev *);
+void i2cbus_begin(uint8_t);
+int i2cbus_queue_write(t_i2cdev *, const void *, size_t);
+int i2cbus_queue_read(t_i2cdev *, void *, size_t);
+int i2cbus_flush(uint8_t);
+ssize_t i2cbus_write(t_i2cdev *, const void *, size_t);
+ssize_t i2cbus_read(t_i2cdev *, void *, size_t);
+void i2cbus_retry(t_i2cdev *);
+void i2cbus_print_stats(FILE *);
+void i2cbus_write_metrics(FILE *);
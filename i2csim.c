@@ -0,0 +1,1348 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "i2csim.h"
+#include "24c16.h"
+#include "clock.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+// A userspace model of the I2C devices of an Openvario board. It replaces the
+// kernel driver as bus backend, so the drivers and the whole pipeline run
+// unchanged on a dev box.
+//
+// The devices run on a simulated clock which advances at a multiple of the
+// monotonic clock. Conversion times, busy flags and the script are based on
+// the simulated clock, so the sensor tick can be shortened by the same
+// factor to run faster than real time.
+//
+// Script format, one setting per line:
+//   speed [factor]                       simulated seconds per second
+//   seed [n]                             seed of the noise generator
+//   point [time s] [altitude m] [airspeed km/h]
+//                                        flight profile, interpolated linearly
+//   noise [Pa]                           pressure noise, standard deviation
+//   temperature [degC]
+//   humidity [%]
+//   voltage [V] [division] [offset]      same parameters as voltage_config
+//   jitter [counts/ms] [decay] [ratio]   MS5611 timing jitter model
+//   humidity_sensor [type]               ds18b20, am2321, sht4x, sht85,
+//                                        si7021, htu21d, htu31d or none
+//   eeprom [zero offset|blank|none]
+//   fault [start s] [duration s] [device] [kind] [value]
+//                                        device: static, tep, dynamic, voltage,
+//                                        eeprom, temp or an address
+//                                        kind: nack, stall [us], drop [counts]
+//                                        or zero
+
+// device types
+enum {
+	SIM_MS5611,
+	SIM_AMS5915,
+	SIM_ADS1110,
+	SIM_24C16,
+	SIM_DS2482,
+	SIM_SHT4X,
+	SIM_SHT85,
+	SIM_SI7021,
+	SIM_HTU21D,
+	SIM_HTU31D,
+	SIM_AM2321
+};
+
+// fault kinds
+enum {
+	FAULT_NACK,
+	FAULT_STALL,
+	FAULT_DROP,
+	FAULT_ZERO
+};
+
+// 1-Wire slave states
+enum {
+	OW_IDLE,
+	OW_ROM,
+	OW_FUNC,
+	OW_MATCH,
+	OW_SEARCH,
+	OW_WRITE_SP
+};
+
+#define SIM_TEMP_ADDRESS 0	// fault address of the temperature sensor
+#define DS2482_PTR_STATUS 0xf0
+#define DS2482_PTR_DATA 0xe1
+#define DS2482_PTR_CONFIG 0xc3
+
+typedef struct {
+	double time;
+	double altitude;
+	double airspeed;
+} t_sim_point;
+
+typedef struct {
+	double start;
+	double end;
+	unsigned char address;
+	int kind;
+	double value;
+} t_sim_fault;
+
+typedef struct t_sim_dev t_sim_dev;
+
+struct t_sim_dev {
+	int type;
+	unsigned char address;
+	int (*write)(t_sim_dev *, const uint8_t *, int);
+	int (*read)(t_sim_dev *, uint8_t *, int);
+	int64_t busy_until;		// not acknowledged before, simulated ns
+	uint8_t out[9];			// response of the last command
+	int nout;
+	int64_t ready_at;		// response available from
+	union {
+		struct {
+			uint16_t prom[8];
+			int ptr;		// PROM word, -1 for the ADC
+			int conv;		// 1 for D1, 2 for D2, 0 if none
+			uint32_t value;
+			int64_t last_start;
+			double interval;	// average conversion interval in ns
+			double offset;		// jitter offset in D2 counts
+		} ms5611;
+		struct {
+			uint8_t mem[2048];
+			uint16_t addr;
+		} eeprom;
+		struct {
+			uint8_t status;
+			uint8_t data;
+			uint8_t config;
+			uint8_t ptr;
+			int present;
+			int state;
+			int n;
+			int bit;
+			uint8_t rom[8];
+			uint8_t scratch[9];
+			int16_t pending;
+			int64_t conv_until;
+		} ds2482;
+		struct {
+			uint8_t user;
+			uint8_t heater;
+			double rh;		// values of the last conversion
+			double t;
+			int64_t awake_until;
+		} hum;
+	};
+};
+
+static struct {
+	int64_t t0;
+	double speed;
+	uint64_t rng;
+	double temperature;
+	double humidity;
+	double voltage;
+	double division;
+	double offset;
+	double noise;
+	double jitter_gain;
+	double jitter_decay;
+	double jitter_ratio;
+	int hum_type;
+	int eeprom;			// 0 none, 1 blank, 2 programmed
+	float eeprom_offset;
+	unsigned char temp_address;
+	t_sim_point points[I2CSIM_MAX_POINTS];
+	int npoints;
+	t_sim_fault faults[I2CSIM_MAX_FAULTS];
+	int nfaults;
+	t_sim_dev devs[I2CSIM_MAX_DEVICES];
+	int ndevs;
+} sim;
+
+static int64_t mono_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+// simulated time in ns since the simulation was opened
+static int64_t sim_now(void)
+{
+	return (mono_ns() - sim.t0) * sim.speed;
+}
+
+// xorshift64*, deterministic for a given seed
+static double sim_uniform(void)
+{
+	sim.rng ^= sim.rng >> 12;
+	sim.rng ^= sim.rng << 25;
+	sim.rng ^= sim.rng >> 27;
+	return ((sim.rng * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double sim_gauss(double sigma)
+{
+	double u = sim_uniform();
+
+	if (sigma == 0.0)
+		return 0.0;
+	if (u < 1e-300) u = 1e-300;
+	return sigma * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * sim_uniform());
+}
+
+static const t_sim_fault *sim_fault(unsigned char address, int kind)
+{
+	double t = sim_now() * 1e-9;
+	int i;
+
+	for (i = 0; i < sim.nfaults; i++) {
+		const t_sim_fault *f = &sim.faults[i];
+		unsigned char a = (f->address == SIM_TEMP_ADDRESS) ? sim.temp_address : f->address;
+
+		if ((a == address) && (f->kind == kind) && (t >= f->start) && (t < f->end))
+			return f;
+	}
+	return NULL;
+}
+
+// Pressures of the flight profile at the simulated time, ISA atmosphere.
+// The TE probe sees the static pressure minus the dynamic pressure.
+static void sim_air(double *p_static, double *p_tep, double *q)
+{
+	double t = sim_now() * 1e-9;
+	double h = 0.0, v = 0.0, f, T, p, rho;
+	int i;
+
+	if (sim.npoints > 0) {
+		for (i = 1; (i < sim.npoints) && (sim.points[i].time <= t); i++);
+		if ((i == sim.npoints) || (t <= sim.points[0].time)) {
+			if (t <= sim.points[0].time) i = 0; else i = sim.npoints - 1;
+			h = sim.points[i].altitude;
+			v = sim.points[i].airspeed;
+		} else {
+			const t_sim_point *a = &sim.points[i-1], *b = &sim.points[i];
+
+			f = (t - a->time) / (b->time - a->time);
+			h = a->altitude + f * (b->altitude - a->altitude);
+			v = a->airspeed + f * (b->airspeed - a->airspeed);
+		}
+	}
+
+	T = 288.15 - 0.0065 * h;
+	p = 101325.0 * pow(T / 288.15, 5.25588);
+	rho = p / (287.05 * T);
+	v /= 3.6;
+
+	*p_static = p;
+	*q = 0.5 * rho * v * v;
+	*p_tep = p - *q;
+}
+
+// CRC-8 of the Sensirion and Silicon Labs parts, x^8+x^5+x^4+1
+static uint8_t crc8_31(const uint8_t *buf, int len, uint8_t crc)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+	}
+	return crc;
+}
+
+// CRC-8 of the 1-Wire ROM and scratchpad, reflected x^8+x^5+x^4+1
+static uint8_t crc8_maxim(const uint8_t *buf, int len)
+{
+	uint8_t crc = 0;
+	int i;
+
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+	}
+	return crc;
+}
+
+// CRC-16 of the AM2321, Modbus
+static uint16_t crc16_modbus(const uint8_t *buf, int len)
+{
+	uint16_t crc = 0xffff;
+	int i;
+
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+	}
+	return crc;
+}
+
+// CRC-4 of the MS5611 PROM, application note AN520
+static uint8_t crc4_prom(const uint16_t *prom)
+{
+	uint16_t rem = 0, word;
+	int cnt, bit;
+
+	for (cnt = 0; cnt < 16; cnt++) {
+		word = (cnt >> 1 == 7) ? (prom[7] & 0xff00) : prom[cnt >> 1];
+		rem ^= (cnt & 1) ? (word & 0xff) : (word >> 8);
+		for (bit = 0; bit < 8; bit++)
+			rem = (rem & 0x8000) ? (rem << 1) ^ 0x3000 : rem << 1;
+	}
+	return (rem >> 12) & 0xf;
+}
+
+// queue a 16 bit word followed by its CRC
+static void sim_word(t_sim_dev *d, uint16_t word, uint8_t init)
+{
+	uint8_t buf[2] = { word >> 8, word & 0xff };
+
+	d->out[d->nout++] = buf[0];
+	d->out[d->nout++] = buf[1];
+	d->out[d->nout++] = crc8_31(buf, 2, init);
+}
+
+static uint16_t sim_code(double value, double offset, double range)
+{
+	double code = (value + offset) * 65535.0 / range;
+
+	if (code < 0) return 0;
+	if (code > 65535) return 65535;
+	return (uint16_t)lrint(code);
+}
+
+// hand out the response, not acknowledged if there is none or it isn't ready
+static int sim_read_out(t_sim_dev *d, uint8_t *buf, int len)
+{
+	if ((d->nout == 0) || (sim_now() < d->ready_at))
+		return -1;
+	memset(buf, 0xff, len);
+	memcpy(buf, d->out, (len < d->nout) ? len : d->nout);
+	d->nout = 0;
+	return 0;
+}
+
+/*
+ * MS5611
+ */
+
+static uint32_t ms5611_adc(t_sim_dev *d, int d2)
+{
+	const uint16_t *c = d->ms5611.prom;
+	double p_static, p_tep, q, p, T, dT, off, sens, value;
+	const t_sim_fault *f;
+
+	// the TE sensor runs a bit warmer
+	T = sim.temperature + ((d->address & 1) ? 0.4 : 0.0);
+	dT = (T * 100.0 - 2000.0) * 8388608.0 / c[6];
+
+	if (d2) {
+		value = dT + c[5] * 256.0 + d->ms5611.offset + sim_gauss(2.0);
+	} else {
+		sim_air(&p_static, &p_tep, &q);
+		p = ((d->address & 1) ? p_tep : p_static) + sim_gauss(sim.noise);
+		off = c[2] * 65536.0 + c[4] * dT / 128.0;
+		sens = c[1] * 32768.0 + c[3] * dT / 256.0;
+		value = (p * 32768.0 + off) * 2097152.0 / sens + d->ms5611.offset * sim.jitter_ratio;
+	}
+
+	if ((f = sim_fault(d->address, FAULT_DROP)) != NULL)
+		value -= f->value;
+	if (value < 0) return 0;
+	if (value > 0xffffff) return 0xffffff;
+	return (uint32_t)lrint(value);
+}
+
+// A change of the conversion interval biases the ADC, the offset decays
+// like a first order low pass. See pressure_measurement_handler().
+static void ms5611_jitter(t_sim_dev *d, int64_t now)
+{
+	double interval = now - d->ms5611.last_start, dev;
+
+	if ((d->ms5611.last_start != 0) && (interval > 0)) {
+		if (d->ms5611.interval == 0)
+			d->ms5611.interval = interval;
+		dev = (interval - d->ms5611.interval) * 1e-6;
+		if (fabs(dev) > 1.0)
+			d->ms5611.offset += sim.jitter_gain * dev;
+		if (d->ms5611.offset > 50000) d->ms5611.offset = 50000;
+		if (d->ms5611.offset < -50000) d->ms5611.offset = -50000;
+		d->ms5611.interval += (interval - d->ms5611.interval) / 64;
+	}
+	d->ms5611.offset *= sim.jitter_decay;
+	d->ms5611.last_start = now;
+}
+
+static int ms5611_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	// conversion time in ns per oversampling ratio
+	static const int64_t conv_ns[5] = { 600000, 1170000, 2280000, 4540000, 9040000 };
+	int64_t now = sim_now();
+	uint8_t cmd;
+
+	if (len == 0)
+		return 0;
+	cmd = buf[0];
+
+	if (cmd == 0x1e) {
+		d->ms5611.conv = 0;
+		d->ms5611.ptr = -1;
+		d->busy_until = now + 2800000;
+	} else if ((cmd & 0xe1) == 0x40) {
+		// D1 0x40..0x48, D2 0x50..0x58
+		if (((cmd >> 1) & 7) > 4)
+			return -1;
+		ms5611_jitter(d, now);
+		d->ms5611.conv = (cmd & 0x10) ? 2 : 1;
+		d->ms5611.value = ms5611_adc(d, d->ms5611.conv == 2);
+		d->ready_at = now + conv_ns[(cmd >> 1) & 7];
+	} else if (cmd == 0x00) {
+		d->ms5611.ptr = -1;
+	} else if ((cmd & 0xf1) == 0xa0) {
+		d->ms5611.ptr = (cmd >> 1) & 7;
+	} else
+		return -1;
+	return 0;
+}
+
+static int ms5611_read(t_sim_dev *d, uint8_t *buf, int len)
+{
+	uint32_t value = 0;
+
+	memset(buf, 0, len);
+	if (d->ms5611.ptr >= 0) {
+		if (len > 0) buf[0] = d->ms5611.prom[d->ms5611.ptr] >> 8;
+		if (len > 1) buf[1] = d->ms5611.prom[d->ms5611.ptr] & 0xff;
+		return 0;
+	}
+
+	// a read during the conversion gives 0, the result is read only once
+	if (d->ms5611.conv && (sim_now() >= d->ready_at) && !sim_fault(d->address, FAULT_ZERO))
+		value = d->ms5611.value;
+	d->ms5611.conv = 0;
+	if (len > 0) buf[0] = value >> 16;
+	if (len > 1) buf[1] = value >> 8;
+	if (len > 2) buf[2] = value;
+	return 0;
+}
+
+static void ms5611_init(t_sim_dev *d)
+{
+	// typical values of the data sheet, each sensor a bit different
+	static const uint16_t typical[8] = { 0, 40127, 36924, 23317, 23282, 33464, 28312, 0 };
+	int i;
+
+	for (i = 0; i < 8; i++)
+		d->ms5611.prom[i] = typical[i] + ((i > 0) && (i < 7) ? (d->address & 1) * 37 * i : 0);
+	d->ms5611.prom[7] = crc4_prom(d->ms5611.prom);
+	d->ms5611.ptr = -1;
+	d->write = ms5611_write;
+	d->read = ms5611_read;
+}
+
+/*
+ * AMS5915-0050-D, 0..50 mbar
+ */
+
+static int ams5915_read(t_sim_dev *d, uint8_t *buf, int len)
+{
+	double p_static, p_tep, q, counts, t_counts;
+	int p, t;
+
+	(void)d;
+	sim_air(&p_static, &p_tep, &q);
+	counts = 1638 + (q / 100.0 + sim_gauss(sim.noise / 100.0)) * (14745 - 1638) / 50.0;
+	t_counts = (sim.temperature + 50.0) * 2048.0 / 200.0;
+	p = (counts < 0) ? 0 : (counts > 16383) ? 16383 : lrint(counts);
+	t = (t_counts < 0) ? 0 : (t_counts > 2047) ? 2047 : lrint(t_counts);
+
+	memset(buf, 0, len);
+	if (len > 0) buf[0] = p >> 8;
+	if (len > 1) buf[1] = p & 0xff;
+	if (len > 2) buf[2] = t >> 3;
+	if (len > 3) buf[3] = (t & 7) << 5;
+	return 0;
+}
+
+/*
+ * ADS1110, battery voltage behind the divider of the board
+ */
+
+static int ads1110_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	(void)d; (void)buf; (void)len;
+	return 0;
+}
+
+static int ads1110_read(t_sim_dev *d, uint8_t *buf, int len)
+{
+	double raw = (sim.voltage - sim.offset) * sim.division;
+	int v = (raw < -32768) ? -32768 : (raw > 32767) ? 32767 : lrint(raw);
+
+	(void)d;
+	memset(buf, 0, len);
+	if (len > 0) buf[0] = (v >> 8) & 0xff;
+	if (len > 1) buf[1] = v & 0xff;
+	if (len > 2) buf[2] = 0x0c;		// continuous, 15 SPS, gain 1
+	return 0;
+}
+
+/*
+ * 24C16, 8 blocks of 256 bytes at 0x50..0x57
+ */
+
+static int eeprom_write_sim(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	uint16_t block = (d->address & 7) << 8;
+	int i;
+
+	if (now < d->busy_until)
+		return -1;
+	if (len == 0)
+		return 0;
+
+	d->eeprom.addr = block | buf[0];
+	if (len == 1)
+		return 0;
+
+	// page write, wraps within the page of 16 bytes
+	for (i = 1; i < len; i++) {
+		d->eeprom.mem[d->eeprom.addr] = buf[i];
+		d->eeprom.addr = (d->eeprom.addr & ~0xf) | ((d->eeprom.addr + 1) & 0xf);
+	}
+	d->busy_until = now + 5000000;
+	return 0;
+}
+
+static int eeprom_read_sim(t_sim_dev *d, uint8_t *buf, int len)
+{
+	int i;
+
+	if (sim_now() < d->busy_until)
+		return -1;
+	for (i = 0; i < len; i++) {
+		buf[i] = d->eeprom.mem[d->eeprom.addr];
+		d->eeprom.addr = (d->eeprom.addr + 1) & 0x7ff;
+	}
+	return 0;
+}
+
+static void eeprom_init(t_sim_dev *d)
+{
+	t_eeprom_data data;
+	uint8_t sum = 0;
+	int i;
+
+	memset(d->eeprom.mem, 0xff, sizeof(d->eeprom.mem));
+	if (sim.eeprom == 2) {
+		memset(&data, 0, sizeof(data));
+		strcpy(data.header, "OV");
+		data.data_version = EEPROM_DATA_VERSION;
+		memcpy(data.serial, "SIM001", 6);
+		data.zero_offset = sim.eeprom_offset;
+		memcpy(d->eeprom.mem, &data, sizeof(data));
+
+		// verify_checksum() adds the checksum byte to the sum it checks,
+		// so the other bytes are balanced to zero with the padding after
+		// the serial number
+		for (i = 0; i < (int)sizeof(data); i++)
+			if (i != (int)offsetof(t_eeprom_data, checksum))
+				sum += d->eeprom.mem[i];
+		d->eeprom.mem[offsetof(t_eeprom_data, serial) + 6] = -sum;
+		memcpy(&data, d->eeprom.mem, sizeof(data));
+		update_checksum(&data);
+		memcpy(d->eeprom.mem, &data, sizeof(data));
+	}
+	d->write = eeprom_write_sim;
+	d->read = eeprom_read_sim;
+}
+
+/*
+ * DS2482-100 with a DS18B20 on its 1-Wire bus
+ */
+
+// bits of the DS2482 status register
+#define DS_1WB 0x01
+#define DS_PPD 0x02
+#define DS_RST 0x10
+#define DS_SBR 0x20
+#define DS_TSB 0x40
+#define DS_DIR 0x80
+
+static int64_t ds18b20_conv_ns(t_sim_dev *d)
+{
+	return 93750000LL << ((d->ds2482.scratch[4] >> 5) & 3);
+}
+
+static void ow_reset(t_sim_dev *d)
+{
+	d->ds2482.state = d->ds2482.present ? OW_ROM : OW_IDLE;
+	d->nout = 0;
+}
+
+static void ow_write_byte(t_sim_dev *d, uint8_t b, int64_t now)
+{
+	double t;
+	int16_t raw;
+
+	switch (d->ds2482.state) {
+	case OW_ROM:
+		switch (b) {
+		case 0xcc: d->ds2482.state = OW_FUNC; break;
+		case 0x55: d->ds2482.state = OW_MATCH; d->ds2482.n = 0; break;
+		case 0xf0: d->ds2482.state = OW_SEARCH; d->ds2482.bit = 0; break;
+		case 0x33:
+			memcpy(d->out, d->ds2482.rom, 8);
+			d->nout = 8;
+			d->ds2482.state = OW_FUNC;
+			break;
+		default: d->ds2482.state = OW_IDLE; break;
+		}
+		break;
+	case OW_MATCH:
+		if (b != d->ds2482.rom[d->ds2482.n])
+			d->ds2482.state = OW_IDLE;
+		else if (++d->ds2482.n == 8)
+			d->ds2482.state = OW_FUNC;
+		break;
+	case OW_FUNC:
+		d->ds2482.state = OW_IDLE;
+		switch (b) {
+		case 0x44:
+			// resolution of the scratchpad config, unused bits cleared
+			t = sim.temperature + sim_gauss(0.05);
+			raw = lrint(t * 16.0);
+			raw &= ~((1 << (3 - ((d->ds2482.scratch[4] >> 5) & 3))) - 1);
+			d->ds2482.pending = raw;
+			d->ds2482.conv_until = now + ds18b20_conv_ns(d);
+			break;
+		case 0xbe:
+			if (now >= d->ds2482.conv_until) {
+				d->ds2482.scratch[0] = d->ds2482.pending & 0xff;
+				d->ds2482.scratch[1] = (uint16_t)d->ds2482.pending >> 8;
+			}
+			d->ds2482.scratch[8] = crc8_maxim(d->ds2482.scratch, 8);
+			memcpy(d->out, d->ds2482.scratch, 9);
+			d->nout = 9;
+			break;
+		case 0x4e:
+			d->ds2482.state = OW_WRITE_SP;
+			d->ds2482.n = 0;
+			break;
+		}
+		break;
+	case OW_WRITE_SP:
+		// TH, TL and config
+		d->ds2482.scratch[2 + d->ds2482.n] = (d->ds2482.n == 2) ? ((b & 0x60) | 0x1f) : b;
+		if (++d->ds2482.n == 3)
+			d->ds2482.state = OW_IDLE;
+		break;
+	}
+}
+
+static uint8_t ow_read_byte(t_sim_dev *d, int64_t now)
+{
+	uint8_t b;
+
+	if (d->nout > 0) {
+		b = d->out[0];
+		memmove(d->out, d->out + 1, --d->nout);
+		return b;
+	}
+	// read slots are held low during a conversion
+	return (now < d->ds2482.conv_until) ? 0x00 : 0xff;
+}
+
+static int ds2482_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	int id, cmp, dir;
+
+	if (len == 0)
+		return 0;
+
+	switch (buf[0]) {
+	case 0xf0:
+		d->ds2482.status = DS_RST;
+		d->ds2482.config = 0;
+		d->ds2482.ptr = DS2482_PTR_STATUS;
+		d->busy_until = 0;
+		return 0;
+	case 0xe1:
+		if ((len < 2) || ((buf[1] != DS2482_PTR_STATUS) && (buf[1] != DS2482_PTR_DATA) && (buf[1] != DS2482_PTR_CONFIG)))
+			return -1;
+		d->ds2482.ptr = buf[1];
+		return 0;
+	case 0xd2:
+		if (len < 2)
+			return -1;
+		d->ds2482.config = buf[1] & 0x0f;
+		d->ds2482.status &= ~DS_RST;
+		d->ds2482.ptr = DS2482_PTR_CONFIG;
+		return 0;
+	}
+
+	// 1-Wire commands are not acknowledged while the 1-Wire bus is busy
+	if (now < d->busy_until)
+		return -1;
+	d->ds2482.ptr = DS2482_PTR_STATUS;
+	d->ds2482.status &= ~DS_RST;
+
+	switch (buf[0]) {
+	case 0xb4:
+		ow_reset(d);
+		d->ds2482.status = d->ds2482.present ? DS_PPD : 0;
+		d->busy_until = now + 1148000;
+		break;
+	case 0xa5:
+		if (len < 2)
+			return -1;
+		ow_write_byte(d, buf[1], now);
+		d->busy_until = now + 8 * 73000;
+		break;
+	case 0x96:
+		d->ds2482.data = ow_read_byte(d, now);
+		d->busy_until = now + 8 * 73000;
+		break;
+	case 0x78:
+		if (len < 2)
+			return -1;
+		if (d->ds2482.state == OW_SEARCH) {
+			id = (d->ds2482.rom[d->ds2482.bit >> 3] >> (d->ds2482.bit & 7)) & 1;
+			cmp = !id;
+			dir = id;
+			if (++d->ds2482.bit == 64)
+				d->ds2482.state = OW_FUNC;
+		} else {
+			id = cmp = 1;
+			dir = (buf[1] & 0x80) ? 1 : 0;
+		}
+		d->ds2482.status = (id ? DS_SBR : 0) | (cmp ? DS_TSB : 0) | (dir ? DS_DIR : 0);
+		d->busy_until = now + 3 * 73000;
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+static int ds2482_read(t_sim_dev *d, uint8_t *buf, int len)
+{
+	uint8_t value;
+
+	switch (d->ds2482.ptr) {
+	case DS2482_PTR_DATA: value = d->ds2482.data; break;
+	case DS2482_PTR_CONFIG: value = d->ds2482.config; break;
+	default:
+		value = d->ds2482.status;
+		if (sim_now() < d->busy_until)
+			value |= DS_1WB;
+		break;
+	}
+	memset(buf, value, len);
+	return 0;
+}
+
+static void ds2482_init(t_sim_dev *d, int present)
+{
+	static const uint8_t serial[6] = { 0x53, 0x49, 0x4d, 0x00, 0x00, 0x01 };
+	static const uint8_t scratch[8] = { 0x50, 0x05, 0x4b, 0x46, 0x7f, 0xff, 0x0c, 0x10 };
+
+	d->ds2482.present = present;
+	d->ds2482.status = DS_RST;
+	d->ds2482.ptr = DS2482_PTR_STATUS;
+	d->ds2482.rom[0] = 0x28;
+	memcpy(d->ds2482.rom + 1, serial, 6);
+	d->ds2482.rom[7] = crc8_maxim(d->ds2482.rom, 7);
+	memcpy(d->ds2482.scratch, scratch, 8);
+	d->ds2482.pending = 0x0550;		// 85 degC at power up
+	d->write = ds2482_write;
+	d->read = ds2482_read;
+}
+
+/*
+ * Temperature/humidity sensors
+ */
+
+static void hum_convert(t_sim_dev *d, int64_t now, int64_t ns)
+{
+	d->hum.t = sim.temperature + sim_gauss(0.02);
+	d->hum.rh = sim.humidity + sim_gauss(0.1);
+	d->ready_at = now + ns;
+	d->nout = 0;
+}
+
+// SHT4x, single byte commands, CRC initialised with 0xff
+static int sht4x_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+
+	if ((len == 0) || (now < d->busy_until))
+		return -1;
+
+	switch (buf[0]) {
+	case 0x94:
+		d->nout = 0;
+		d->busy_until = now + 1000000;
+		break;
+	case 0x89:
+		d->nout = 0;
+		sim_word(d, 0x1234, 0xff);
+		sim_word(d, 0x5678, 0xff);
+		d->ready_at = now;
+		break;
+	case 0xfd: case 0xf6: case 0xe0:
+		hum_convert(d, now, 8300000);
+		sim_word(d, sim_code(d->hum.t, 45, 175), 0xff);
+		sim_word(d, sim_code(d->hum.rh, 6, 125), 0xff);
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+// SHT85, 16 bit commands, CRC initialised with 0xff
+static int sht85_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	uint16_t cmd;
+
+	if ((len < 2) || (now < d->busy_until))
+		return -1;
+	cmd = (buf[0] << 8) | buf[1];
+
+	switch (cmd) {
+	case 0x30a2:
+		d->nout = 0;
+		d->hum.heater = 0;
+		d->busy_until = now + 1500000;
+		break;
+	case 0x3682:
+		d->nout = 0;
+		sim_word(d, 0x8531, 0xff);
+		sim_word(d, 0x0042, 0xff);
+		d->ready_at = now;
+		break;
+	case 0x2400: case 0x240b: case 0x2416:
+		hum_convert(d, now, 15500000);
+		sim_word(d, sim_code(d->hum.t, 45, 175), 0xff);
+		sim_word(d, sim_code(d->hum.rh, 0, 100), 0xff);
+		break;
+	case 0x306d: case 0x3066:
+		d->hum.heater = (cmd == 0x306d);
+		break;
+	case 0xf32d:
+		d->nout = 0;
+		sim_word(d, d->hum.heater ? 0x2000 : 0x0000, 0xff);
+		d->ready_at = now;
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+// SI7021 and HTU21D, CRC initialised with 0
+static int si7021_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	int htu21d = (d->type == SIM_HTU21D);
+	uint8_t sn[8];
+	int i;
+
+	if ((len == 0) || (now < d->busy_until))
+		return -1;
+
+	switch (buf[0]) {
+	case 0xfe:
+		d->nout = 0;
+		d->hum.user = 0x3a;
+		d->hum.heater = 0;
+		d->busy_until = now + 15000000;
+		break;
+	case 0xe6:
+		if (len < 2) return -1;
+		d->hum.user = buf[1];
+		break;
+	case 0xe7:
+		d->out[0] = d->hum.user;
+		d->nout = 1;
+		d->ready_at = now;
+		break;
+	case 0x51:
+		if (len < 2) return -1;
+		d->hum.heater = buf[1] & 0x0f;
+		break;
+	case 0x11:
+		d->out[0] = d->hum.heater;
+		d->nout = 1;
+		d->ready_at = now;
+		break;
+	case 0xf5: case 0xe5:
+		// the temperature of a humidity conversion is kept for 0xe0
+		hum_convert(d, now, (buf[0] == 0xe5) ? 0 : 12000000);
+		sim_word(d, sim_code(d->hum.rh, 6, 125), 0);
+		break;
+	case 0xf3: case 0xe3:
+		hum_convert(d, now, (buf[0] == 0xe3) ? 0 : (htu21d ? 44000000 : 10800000));
+		sim_word(d, sim_code(d->hum.t, 46.85, 175.72), 0);
+		break;
+	case 0xe0:
+		d->nout = 0;
+		sim_word(d, sim_code(d->hum.t, 46.85, 175.72), 0);
+		d->ready_at = now;
+		break;
+	case 0xfa:
+		// serial number A, every byte with its CRC
+		if ((len < 2) || (buf[1] != 0x0f)) return -1;
+		sn[0] = 0x53; sn[2] = 0x49; sn[4] = 0x4d; sn[6] = 0x01;
+		for (i = 0; i < 8; i += 2)
+			sn[i+1] = crc8_31(&sn[i], 1, 0);
+		memcpy(d->out, sn, 8);
+		d->nout = 8;
+		d->ready_at = now;
+		break;
+	case 0xfc:
+		// serial number B, the first byte is the device id
+		if ((len < 2) || (buf[1] != 0xc9)) return -1;
+		sn[0] = htu21d ? 0x32 : 0x15;
+		sn[1] = 0x00;
+		sn[3] = htu21d ? 0x48 : 0x00;
+		sn[4] = htu21d ? 0x54 : 0x01;
+		sn[2] = crc8_31(&sn[0], 2, 0);
+		sn[5] = crc8_31(&sn[3], 2, 0);
+		memcpy(d->out, sn, 6);
+		d->nout = 6;
+		d->ready_at = now;
+		break;
+	case 0x84:
+		if ((len < 2) || (buf[1] != 0xb8) || htu21d) return -1;
+		d->out[0] = 0x20;
+		d->nout = 1;
+		d->ready_at = now;
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+// HTU31D, every byte is a command
+static int htu31d_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	int i;
+
+	if ((len == 0) || (now < d->busy_until))
+		return -1;
+
+	for (i = 0; i < len; i++) {
+		switch (buf[i]) {
+		case 0x1e:
+			d->nout = 0;
+			d->hum.heater = 0;
+			d->busy_until = now + 15000000;
+			break;
+		case 0x08:
+			d->out[0] = d->hum.heater ? 1 : 0;
+			d->nout = 1;
+			d->ready_at = now;
+			break;
+		case 0x0a:
+			d->out[0] = 0x0f; d->out[1] = 0x31; d->out[2] = 0x00;
+			d->out[3] = crc8_31(d->out, 3, 0);
+			d->nout = 4;
+			d->ready_at = now;
+			break;
+		case 0x04: case 0x02:
+			d->hum.heater = (buf[i] == 0x04);
+			break;
+		case 0x00:
+			d->nout = 0;
+			sim_word(d, sim_code(d->hum.t, 40, 165), 0);
+			sim_word(d, sim_code(d->hum.rh, 0, 100), 0);
+			break;
+		default:
+			// conversion with the oversampling in bits 1..4
+			if ((buf[i] & 0xe1) != 0x40)
+				return -1;
+			hum_convert(d, now, 20000000);
+			break;
+		}
+	}
+	return 0;
+}
+
+// AM2321, sleeps after 3 s, woken up by an empty write
+static int am2321_write(t_sim_dev *d, const uint8_t *buf, int len)
+{
+	int64_t now = sim_now();
+	uint16_t rh, t, crc;
+
+	if (len == 0) {
+		d->hum.awake_until = now + 3000000000LL;
+		return 0;
+	}
+	if ((now >= d->hum.awake_until) || (len < 3) || (buf[0] != 0x03) || (buf[1] != 0x00) || (buf[2] != 0x04))
+		return -1;
+
+	hum_convert(d, now, 1500000);
+	rh = lrint(d->hum.rh * 10.0);
+	t = (d->hum.t < 0) ? (0x8000 | lrint(-d->hum.t * 10.0)) : lrint(d->hum.t * 10.0);
+	d->out[0] = 0x03;
+	d->out[1] = 0x04;
+	d->out[2] = rh >> 8;
+	d->out[3] = rh & 0xff;
+	d->out[4] = t >> 8;
+	d->out[5] = t & 0xff;
+	crc = crc16_modbus(d->out, 6);
+	d->out[6] = crc & 0xff;
+	d->out[7] = crc >> 8;
+	d->nout = 8;
+	return 0;
+}
+
+/*
+ * Bus backend
+ */
+
+static t_sim_dev *sim_add(int type, unsigned char address)
+{
+	t_sim_dev *d;
+
+	if (sim.ndevs == I2CSIM_MAX_DEVICES)
+		return NULL;
+	d = &sim.devs[sim.ndevs++];
+	memset(d, 0, sizeof(*d));
+	d->type = type;
+	d->address = address;
+	d->read = sim_read_out;
+	return d;
+}
+
+static t_sim_dev *sim_find(unsigned char address)
+{
+	int i;
+
+	for (i = 0; i < sim.ndevs; i++) {
+		if ((sim.devs[i].type == SIM_24C16) && ((address & 0xf8) == 0x50))
+			return &sim.devs[i];
+		if (sim.devs[i].address == address)
+			return &sim.devs[i];
+	}
+	return NULL;
+}
+
+// the simulated board has all devices on bus 1
+static int sim_attach(uint8_t bus)
+{
+	if (bus != 1) {
+		fprintf(stderr, "Simulated I2C bus %hhu not present\n", bus);
+		return -1;
+	}
+	return bus;
+}
+
+static void sim_detach(int fd)
+{
+	(void)fd;
+}
+
+static int sim_transfer(int fd, struct i2c_msg *msgs, int nmsgs)
+{
+	const t_sim_fault *f;
+	struct timespec stall;
+	t_sim_dev *d;
+	int i, result;
+
+	(void)fd;
+	for (i = 0; i < nmsgs; i++) {
+		d = sim_find(msgs[i].addr);
+		if (d == NULL)
+			return -1;
+		if (sim_fault(msgs[i].addr, FAULT_NACK) != NULL)
+			return -1;
+		if ((f = sim_fault(msgs[i].addr, FAULT_STALL)) != NULL) {
+			// the device stretches the clock
+			stall.tv_sec = f->value / 1000000;
+			stall.tv_nsec = fmod(f->value, 1000000) * 1000;
+			nanosleep(&stall, NULL);
+		}
+
+		if (d->type == SIM_24C16)
+			d->address = msgs[i].addr;
+		if (msgs[i].flags & I2C_M_RD)
+			result = d->read(d, msgs[i].buf, msgs[i].len);
+		else
+			result = d->write(d, msgs[i].buf, msgs[i].len);
+		if (result != 0)
+			return -1;
+	}
+	return nmsgs;
+}
+
+static const t_i2cbus_backend sim_backend = {
+	.attach = sim_attach,
+	.detach = sim_detach,
+	.transfer = sim_transfer,
+};
+
+static int sim_device_address(const char *name, unsigned char *address)
+{
+	static const struct {
+		const char *name;
+		unsigned char address;
+	} names[] = {
+		{ "static", 0x76 },
+		{ "tep", 0x77 },
+		{ "dynamic", 0x28 },
+		{ "voltage", 0x48 },
+		{ "eeprom", 0x50 },
+		{ "temp", SIM_TEMP_ADDRESS },
+	};
+	char *end;
+	long a;
+	int i;
+
+	for (i = 0; i < (int)(sizeof(names)/sizeof(names[0])); i++)
+		if (strcmp(name, names[i].name) == 0) {
+			*address = names[i].address;
+			return 0;
+		}
+	a = strtol(name, &end, 0);
+	if ((*end != '\0') || (a <= 0) || (a > 0x7f))
+		return 1;
+	*address = a;
+	return 0;
+}
+
+static int sim_parse(FILE *fp)
+{
+	static const char *hum_names[] = { "ds18b20", "am2321", "sht4x", "sht85", "si7021", "htu21d", "htu31d", "none" };
+	static const int hum_types[] = { SIM_DS2482, SIM_AM2321, SIM_SHT4X, SIM_SHT85, SIM_SI7021, SIM_HTU21D, SIM_HTU31D, -1 };
+	char line[100];
+	char tmp[20], arg[20], kind[20];
+	t_sim_point *p;
+	t_sim_fault *f;
+	int n, i, lineno = 0;
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		lineno++;
+		if ((line[0] == '#') || (sscanf(line, "%19s", tmp) != 1))
+			continue;
+
+		if (strcmp(tmp, "speed") == 0)
+			n = sscanf(line, "%19s %lf", tmp, &sim.speed) - 1;
+		else if (strcmp(tmp, "seed") == 0)
+			n = sscanf(line, "%19s %" SCNu64, tmp, &sim.rng) - 1;
+		else if (strcmp(tmp, "noise") == 0)
+			n = sscanf(line, "%19s %lf", tmp, &sim.noise) - 1;
+		else if (strcmp(tmp, "temperature") == 0)
+			n = sscanf(line, "%19s %lf", tmp, &sim.temperature) - 1;
+		else if (strcmp(tmp, "humidity") == 0)
+			n = sscanf(line, "%19s %lf", tmp, &sim.humidity) - 1;
+		else if (strcmp(tmp, "voltage") == 0)
+			n = (sscanf(line, "%19s %lf %lf %lf", tmp, &sim.voltage, &sim.division, &sim.offset) > 1);
+		else if (strcmp(tmp, "jitter") == 0)
+			n = (sscanf(line, "%19s %lf %lf %lf", tmp, &sim.jitter_gain, &sim.jitter_decay, &sim.jitter_ratio) > 1);
+		else if (strcmp(tmp, "point") == 0) {
+			if (sim.npoints == I2CSIM_MAX_POINTS) {
+				fprintf(stderr, "Simulation line %d: too many points\n", lineno);
+				return 1;
+			}
+			p = &sim.points[sim.npoints];
+			n = (sscanf(line, "%19s %lf %lf %lf", tmp, &p->time, &p->altitude, &p->airspeed) == 4);
+			if (n && (sim.npoints > 0) && (p->time <= sim.points[sim.npoints-1].time))
+				n = 0;
+			sim.npoints += n;
+		} else if (strcmp(tmp, "humidity_sensor") == 0) {
+			n = 0;
+			if (sscanf(line, "%19s %19s", tmp, arg) == 2)
+				for (i = 0; i < (int)(sizeof(hum_names)/sizeof(hum_names[0])); i++)
+					if (strcmp(arg, hum_names[i]) == 0) {
+						sim.hum_type = hum_types[i];
+						n = 1;
+					}
+		} else if (strcmp(tmp, "eeprom") == 0) {
+			n = (sscanf(line, "%19s %19s", tmp, arg) == 2);
+			if (n && (strcmp(arg, "none") == 0))
+				sim.eeprom = 0;
+			else if (n && (strcmp(arg, "blank") == 0))
+				sim.eeprom = 1;
+			else if (n) {
+				sim.eeprom = 2;
+				sim.eeprom_offset = atof(arg);
+			}
+		} else if (strcmp(tmp, "fault") == 0) {
+			if (sim.nfaults == I2CSIM_MAX_FAULTS) {
+				fprintf(stderr, "Simulation line %d: too many faults\n", lineno);
+				return 1;
+			}
+			f = &sim.faults[sim.nfaults];
+			f->value = 0;
+			n = (sscanf(line, "%19s %lf %lf %19s %19s %lf", tmp, &f->start, &f->end, arg, kind, &f->value) >= 5) &&
+				(sim_device_address(arg, &f->address) == 0);
+			f->end += f->start;
+			if (strcmp(kind, "nack") == 0) f->kind = FAULT_NACK;
+			else if (strcmp(kind, "stall") == 0) f->kind = FAULT_STALL;
+			else if (strcmp(kind, "drop") == 0) f->kind = FAULT_DROP;
+			else if (strcmp(kind, "zero") == 0) f->kind = FAULT_ZERO;
+			else n = 0;
+			sim.nfaults += n;
+		} else {
+			fprintf(stderr, "Simulation line %d: unknown setting %s\n", lineno, tmp);
+			return 1;
+		}
+
+		if (n < 1) {
+			fprintf(stderr, "Simulation line %d: invalid %s\n", lineno, tmp);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+* @brief Replace the I2C busses by the simulated board
+* @param script file with the flight profile, sensor values and faults, NULL for defaults
+* @return result
+*
+* Has to be called before the first device is opened.
+*
+* @date 18.10.2026 born
+*
+*/
+int i2csim_open(const char *script)
+{
+	FILE *fp;
+	t_sim_dev *d;
+	int result;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.speed = 1.0;
+	sim.rng = 0x5eed;
+	sim.temperature = 20.0;
+	sim.humidity = 50.0;
+	sim.voltage = 12.6;
+	sim.division = 1248.6;
+	sim.offset = 0.645;
+	sim.noise = 1.5;
+	sim.jitter_gain = -150.0;
+	sim.jitter_decay = 0.97;
+	sim.jitter_ratio = -0.27;
+	sim.hum_type = SIM_DS2482;
+	sim.eeprom = 2;
+
+	if (script != NULL) {
+		fp = fopen(script, "r");
+		if (fp == NULL) {
+			fprintf(stderr, "Error opening simulation %s\n", script);
+			return 1;
+		}
+		result = sim_parse(fp);
+		fclose(fp);
+		if (result != 0)
+			return 1;
+	}
+	if ((sim.speed <= 0) || (sim.rng == 0)) {
+		fprintf(stderr, "Simulation speed and seed have to be positive\n");
+		return 1;
+	}
+
+	ms5611_init(sim_add(SIM_MS5611, 0x76));
+	ms5611_init(sim_add(SIM_MS5611, 0x77));
+	sim_add(SIM_AMS5915, 0x28)->read = ams5915_read;
+	d = sim_add(SIM_ADS1110, 0x48);
+	d->write = ads1110_write;
+	d->read = ads1110_read;
+	if (sim.eeprom)
+		eeprom_init(sim_add(SIM_24C16, 0x50));
+
+	switch (sim.hum_type) {
+	case SIM_DS2482:
+		ds2482_init(sim_add(SIM_DS2482, 0x18), 1);
+		sim.temp_address = 0x18;
+		break;
+	case SIM_SHT4X:
+		sim_add(SIM_SHT4X, 0x44)->write = sht4x_write;
+		sim.temp_address = 0x44;
+		break;
+	case SIM_SHT85:
+		sim_add(SIM_SHT85, 0x44)->write = sht85_write;
+		sim.temp_address = 0x44;
+		break;
+	case SIM_SI7021: case SIM_HTU21D:
+		sim_add(sim.hum_type, 0x40)->write = si7021_write;
+		sim.temp_address = 0x40;
+		break;
+	case SIM_HTU31D:
+		sim_add(SIM_HTU31D, 0x40)->write = htu31d_write;
+		sim.temp_address = 0x40;
+		break;
+	case SIM_AM2321:
+		sim_add(SIM_AM2321, 0x5c)->write = am2321_write;
+		sim.temp_address = 0x5c;
+		break;
+	}
+
+	sim.t0 = mono_ns();
+	i2cbus_set_backend(&sim_backend);
+	fprintf(stderr, "!! SIMULATED I2C BUS, %d devices, speed %.1f !!\n", sim.ndevs, sim.speed);
+	return 0;
+}
+
+/**
+* @brief Simulated monotonic clock
+* @param t time of the simulated devices
+* @return
+*
+* Runs at the simulation speed from the time the simulation was opened.
+*
+* @date 18.10.2026 born
+*
+*/
+void i2csim_clock(struct timespec *t)
+{
+	int64_t ns = sim.t0 + sim_now();
+
+	t->tv_sec = ns / 1000000000;
+	t->tv_nsec = ns % 1000000000;
+}
+
+float i2csim_speed(void)
+{
+	return sim.speed;
+}
@@ -0,0 +1,33 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "i2cbus.h"
+
+#include <time.h>
+
+#define I2CSIM_MAX_DEVICES 12
+#define I2CSIM_MAX_POINTS 256
+#define I2CSIM_MAX_FAULTS 32
+
+int i2csim_open(const char *);
+void i2csim_clock(struct timespec *);
+float i2csim_speed(void);
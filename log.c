@@ -19,4 +19,384 @@
 
 #include "log.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
 int g_debug=0;
+
+// argument types of a captured record
+enum {
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_PTR,
+	LOG_ARG_STR
+};
+
+typedef union {
+	long long i;
+	double d;
+	const void *p;
+	size_t s;			// offset into strings
+} t_log_arg;
+
+// One slot of the ring. The format string is not copied, it has to be a
+// literal. Strings are copied since they may be gone when the record is
+// written. Records which can't be captured are formatted right away and
+// stored as text with fmt set to NULL.
+typedef struct {
+	atomic_ulong seq;
+	struct timespec time;
+	const char *fmt;
+	int nargs;
+	unsigned char type[LOG_MAX_ARGS];
+	t_log_arg args[LOG_MAX_ARGS];
+	char strings[LOG_STRINGS];
+} t_log_record;
+
+static t_log_record log_ring[LOG_RING_SIZE];
+static atomic_ulong log_head;		// next slot to claim by a producer
+static unsigned long log_tail;		// next slot to write, owned by the consumer
+static atomic_ulong log_dropped;
+static atomic_int log_running;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static int log_line_start = 1;
+
+// Parse one conversion specification at fmt, which points past the '%'.
+// Returns a pointer to the conversion character and sets the length modifier.
+static const char *log_parse_spec(const char *fmt, int *star, char *len)
+{
+	*star = 0;
+	*len = 0;
+
+	while (strchr("-+ #0'", *fmt) && *fmt) fmt++;
+	if (*fmt == '*') { (*star)++; fmt++; }
+	while ((*fmt >= '0') && (*fmt <= '9')) fmt++;
+	if (*fmt == '.') {
+		fmt++;
+		if (*fmt == '*') { (*star)++; fmt++; }
+		while ((*fmt >= '0') && (*fmt <= '9')) fmt++;
+	}
+	switch (*fmt) {
+	case 'h':
+		*len = (fmt[1] == 'h') ? 'H' : 'h';
+		fmt += (fmt[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		*len = (fmt[1] == 'l') ? 'q' : 'l';
+		fmt += (fmt[1] == 'l') ? 2 : 1;
+		break;
+	case 'L': case 'j': case 'z': case 't':
+		*len = *fmt++;
+		break;
+	}
+	return fmt;
+}
+
+// Copy the arguments into a record, returns 1 if the format can't be deferred
+static int log_capture(t_log_record *rec, const char *fmt, va_list ap)
+{
+	size_t used = 0, n;
+	const char *s;
+	char len;
+	int star;
+
+	rec->nargs = 0;
+	for (; *fmt; fmt++) {
+		if (*fmt != '%') continue;
+		if (*++fmt == '%') continue;
+
+		fmt = log_parse_spec(fmt, &star, &len);
+		if (rec->nargs + star + 1 > LOG_MAX_ARGS)
+			return 1;
+		while (star--) {
+			rec->type[rec->nargs] = LOG_ARG_INT;
+			rec->args[rec->nargs++].i = va_arg(ap, int);
+		}
+
+		switch (*fmt) {
+		case 'd': case 'i':
+			rec->type[rec->nargs] = LOG_ARG_LONG;
+			switch (len) {
+			case 'H': rec->args[rec->nargs].i = (signed char)va_arg(ap, int); break;
+			case 'h': rec->args[rec->nargs].i = (short)va_arg(ap, int); break;
+			case 'l': rec->args[rec->nargs].i = va_arg(ap, long); break;
+			case 'q': rec->args[rec->nargs].i = va_arg(ap, long long); break;
+			case 'j': rec->args[rec->nargs].i = va_arg(ap, intmax_t); break;
+			case 'z': rec->args[rec->nargs].i = va_arg(ap, ssize_t); break;
+			case 't': rec->args[rec->nargs].i = va_arg(ap, ptrdiff_t); break;
+			default: rec->args[rec->nargs].i = va_arg(ap, int); break;
+			}
+			break;
+		case 'o': case 'u': case 'x': case 'X':
+			rec->type[rec->nargs] = LOG_ARG_LONG;
+			switch (len) {
+			case 'H': rec->args[rec->nargs].i = (unsigned char)va_arg(ap, unsigned int); break;
+			case 'h': rec->args[rec->nargs].i = (unsigned short)va_arg(ap, unsigned int); break;
+			case 'l': rec->args[rec->nargs].i = va_arg(ap, unsigned long); break;
+			case 'q': rec->args[rec->nargs].i = va_arg(ap, unsigned long long); break;
+			case 'j': rec->args[rec->nargs].i = va_arg(ap, uintmax_t); break;
+			case 'z': rec->args[rec->nargs].i = va_arg(ap, size_t); break;
+			case 't': rec->args[rec->nargs].i = va_arg(ap, ptrdiff_t); break;
+			default: rec->args[rec->nargs].i = va_arg(ap, unsigned int); break;
+			}
+			break;
+		case 'c':
+			if (len) return 1;
+			rec->type[rec->nargs] = LOG_ARG_INT;
+			rec->args[rec->nargs].i = va_arg(ap, int);
+			break;
+		case 'e': case 'E': case 'f': case 'F':
+		case 'g': case 'G': case 'a': case 'A':
+			if (len) return 1;
+			rec->type[rec->nargs] = LOG_ARG_DOUBLE;
+			rec->args[rec->nargs].d = va_arg(ap, double);
+			break;
+		case 'p':
+			rec->type[rec->nargs] = LOG_ARG_PTR;
+			rec->args[rec->nargs].p = va_arg(ap, void *);
+			break;
+		case 's':
+			if (len) return 1;
+			s = va_arg(ap, const char *);
+			if (s == NULL) s = "(null)";
+			n = strlen(s) + 1;
+			if (used + n > LOG_STRINGS)
+				return 1;
+			memcpy(rec->strings + used, s, n);
+			rec->type[rec->nargs] = LOG_ARG_STR;
+			rec->args[rec->nargs].s = used;
+			used += n;
+			break;
+		default:
+			// %n, %m and friends
+			return 1;
+		}
+		rec->nargs++;
+	}
+	return 0;
+}
+
+/**
+* @brief Queue a log message for the writer thread
+* @param fmt printf format, has to be a string literal
+*
+* The arguments are copied into a slot of a lock-free ring, formatting and
+* writing is left to the writer thread. The message is dropped if the ring
+* is full, so a caller is never blocked. Before log_start() the message is
+* printed right away.
+*
+* @date 18.10.2026 born
+*
+*/
+void log_printf(const char *fmt, ...)
+{
+	t_log_record *rec;
+	unsigned long pos, seq;
+	long diff;
+	va_list ap, aq;
+
+	va_start(ap, fmt);
+	if (!atomic_load_explicit(&log_running, memory_order_acquire)) {
+		vfprintf(stderr, fmt, ap);
+		va_end(ap);
+		return;
+	}
+
+	// claim a slot, each slot carries the position it is free for
+	pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+	for (;;) {
+		rec = &log_ring[pos & (LOG_RING_SIZE - 1)];
+		seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+		diff = (long)(seq - pos);
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&log_head, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+			va_end(ap);
+			return;
+		} else {
+			pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &rec->time);
+	rec->fmt = fmt;
+	va_copy(aq, ap);
+	if (log_capture(rec, fmt, aq)) {
+		rec->fmt = NULL;
+		vsnprintf(rec->strings, LOG_STRINGS, fmt, ap);
+	}
+	va_end(aq);
+	va_end(ap);
+
+	// publish
+	atomic_store_explicit(&rec->seq, pos + 1, memory_order_release);
+}
+
+// Format a record, one conversion at a time
+static size_t log_format(const t_log_record *rec, char *buf, size_t size)
+{
+	const char *fmt = rec->fmt, *start;
+	char spec[32], len;
+	size_t n = 0;
+	int star, i = 0, k, m;
+
+#define LOG_APPEND(...) do { \
+		m = snprintf(buf + n, size - n, __VA_ARGS__); \
+		if (m > 0) n = ((size_t)m < size - n) ? n + m : size - 1; \
+	} while (0)
+
+	if (fmt == NULL) {
+		LOG_APPEND("%s", rec->strings);
+		return n;
+	}
+
+	while (*fmt) {
+		if ((*fmt != '%') || (fmt[1] == '%')) {
+			if (n < size - 1) buf[n++] = *fmt;
+			fmt += (*fmt == '%') ? 2 : 1;
+			continue;
+		}
+
+		// rebuild the specification without length modifier and with
+		// the '*' fields resolved
+		start = fmt++;
+		fmt = log_parse_spec(fmt, &star, &len);
+		for (k = 0; (start < fmt) && (k < (int)sizeof(spec) - 16); start++) {
+			if (*start == '*')
+				k += snprintf(spec + k, sizeof(spec) - k, "%d", (int)rec->args[i++].i);
+			else if (!strchr("hlLjzt", *start))
+				spec[k++] = *start;
+		}
+
+		switch (rec->type[i]) {
+		case LOG_ARG_INT:
+			spec[k] = *fmt; spec[k+1] = 0;
+			LOG_APPEND(spec, (int)rec->args[i].i);
+			break;
+		case LOG_ARG_LONG:
+			spec[k] = 'l'; spec[k+1] = 'l'; spec[k+2] = *fmt; spec[k+3] = 0;
+			LOG_APPEND(spec, rec->args[i].i);
+			break;
+		case LOG_ARG_DOUBLE:
+			spec[k] = *fmt; spec[k+1] = 0;
+			LOG_APPEND(spec, rec->args[i].d);
+			break;
+		case LOG_ARG_PTR:
+			spec[k] = *fmt; spec[k+1] = 0;
+			LOG_APPEND(spec, rec->args[i].p);
+			break;
+		case LOG_ARG_STR:
+			spec[k] = *fmt; spec[k+1] = 0;
+			LOG_APPEND(spec, rec->strings + rec->args[i].s);
+			break;
+		}
+		i++;
+		fmt++;
+	}
+#undef LOG_APPEND
+	return n;
+}
+
+/**
+* @brief Write all queued log messages
+*
+* Called by the writer thread and on exit.
+*
+* @date 18.10.2026 born
+*
+*/
+void log_drain(void)
+{
+	t_log_record *rec;
+	unsigned long dropped;
+	char line[512];
+	size_t n;
+
+	pthread_mutex_lock(&log_lock);
+	for (;;) {
+		rec = &log_ring[log_tail & (LOG_RING_SIZE - 1)];
+		if (atomic_load_explicit(&rec->seq, memory_order_acquire) != log_tail + 1)
+			break;
+
+		// prefix each line with the time the message was queued
+		n = 0;
+		if (log_line_start)
+			n = snprintf(line, sizeof(line), "%5ld.%06ld ",
+				     (long)rec->time.tv_sec, rec->time.tv_nsec / 1000);
+		n += log_format(rec, line + n, sizeof(line) - n);
+		log_line_start = (n > 0) && (line[n-1] == '\n');
+		fwrite(line, 1, n, stderr);
+
+		// hand the slot back to the producers
+		atomic_store_explicit(&rec->seq, log_tail + LOG_RING_SIZE, memory_order_release);
+		log_tail++;
+	}
+
+	dropped = atomic_exchange_explicit(&log_dropped, 0, memory_order_relaxed);
+	if (dropped > 0) {
+		fprintf(stderr, "%slog: %lu messages dropped\n", log_line_start ? "" : "\n", dropped);
+		log_line_start = 1;
+	}
+	pthread_mutex_unlock(&log_lock);
+}
+
+static void *log_thread(void *arg)
+{
+	struct timespec interval = { 0, LOG_DRAIN_INTERVAL };
+
+	(void)arg;
+	for (;;) {
+		log_drain();
+		nanosleep(&interval, NULL);
+	}
+	return NULL;
+}
+
+/**
+* @brief Start the writer thread, messages are queued from now on
+* @return result
+*
+* The thread does not take any signals, they stay with the threads which
+* expect them.
+*
+* @date 18.10.2026 born
+*
+*/
+int log_start(void)
+{
+	pthread_t thread;
+	sigset_t all, old;
+	unsigned long i;
+	int err;
+
+	for (i = 0; i < LOG_RING_SIZE; i++)
+		atomic_init(&log_ring[i].seq, i);
+
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	err = pthread_create(&thread, NULL, log_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (err != 0) {
+		fprintf(stderr, "Unable to start log thread: %s\n", strerror(err));
+		return 1;
+	}
+	pthread_detach(thread);
+
+	atexit(log_drain);
+	atomic_store_explicit(&log_running, 1, memory_order_release);
+	return 0;
+}
@@ -23,5 +23,25 @@
 
 extern int g_debug;
 
-#define debug_print(...) if(g_debug>0)fprintf(stderr,__VA_ARGS__)
-#define ddebug_print(...) if(g_debug>1)fprintf(stderr,__VA_ARGS__)
+// Highest debug level compiled in, calls above it are removed entirely.
+// Build with LOG_LEVEL=0 to strip all debug output from the hot path.
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 2
+#endif
+
+// slots of the log ring, must be a power of two
+#define LOG_RING_SIZE 256
+#define LOG_MAX_ARGS 8
+#define LOG_STRINGS 96
+
+// the writer thread drains the ring every 20 ms
+#define LOG_DRAIN_INTERVAL 20000000
+
+#define log_enabled(level) ((LOG_MAX_LEVEL >= (level)) && (g_debug >= (level)))
+
+#define debug_print(...) do { if (log_enabled(1)) log_printf(__VA_ARGS__); } while (0)
+#define ddebug_print(...) do { if (log_enabled(2)) log_printf(__VA_ARGS__); } while (0)
+
+void log_printf(const char *, ...) __attribute__((format(printf, 1, 2)));
+int log_start(void);
+void log_drain(void);
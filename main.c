@@ -31,6 +31,21 @@
 #include "24c16.h"
 #include "wait.h"
 #include "clock.h"
+#include "reactor.h"
+#include "outq.h"
+#include "ring.h"
+#include "rt.h"
+#include "snapshot.h"
+#include "probe.h"
+#include "server.h"
+#include "airdata.h"
+#include "binframe.h"
+#include "decim.h"
+#include "hist.h"
+#include "metrics.h"
+#include "i2csim.h"
+#include "rawlog.h"
+#include "recorder.h"
 #include "log.h"
 
 #include <stdio.h>
@@ -48,10 +63,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <arpa/inet.h>
 #include <syslog.h>
+#include <pthread.h>
 
-// Sensor objects
+// Sensor objects, the pressure and voltage sensors belong to the acquisition thread
 static t_ms5611 static_sensor;
 static t_ms5611 tep_sensor;
 static t_ams5915 dynamic_sensor;
@@ -64,6 +82,7 @@ static t_config config;
 
 // Filter objects
 static t_kalmanfilter1d vkf;
+static t_glitch glitch_state;
 
 // pressures
 static float p_static;
@@ -71,6 +90,104 @@ static float p_dynamic;
 
 static t_io_mode io_mode;
 
+// event loop of the output side
+static t_reactor reactor;
+static t_reactor_timer temp_tick;
+static t_reactor_timer humidity_timer;
+static t_reactor_timer snapshot_tick;
+
+// acquisition thread
+static pthread_t acquisition;
+static t_reactor acq_reactor;
+static t_reactor_timer sensor_tick;
+static t_ring sample_ring;
+
+// simulated seconds per second, the sensor tick is shortened by this factor
+static float time_scale = 1.0;
+
+// raw words of the tick being replayed
+static t_sample replay_tick;
+
+// the pressure replay format has no time stamps, a tick is taken as 12.5ms
+#define REPLAY_TICK_NS 12500000
+
+// a paced replay which falls behind by more than this, in s, starts over from
+// the current tick instead of catching up
+#define REPLAY_MAX_BEHIND 1.0
+
+// samples through the output side of a replay, for the throughput report
+static struct {
+	struct timespec start;
+	struct timespec first;		// sensor clock of the first and the last sample
+	struct timespec last;
+	unsigned long samples;
+} replay_stats;
+
+// binary recording
+static t_recorder recorder;
+
+// warm start state, published by the acquisition thread
+static t_snapshot_slot snapshot_slot;
+static int warm_start;
+
+// interval of the wake-up latency report in s
+#define LATENCY_REPORT_INTERVAL 60
+
+// wake-up latency of the sensor tick, collected by the output side
+static struct {
+	struct timespec start;
+	unsigned long ticks;
+	unsigned long late;		// ticks serviced more than 2ms late
+	unsigned long glitches;		// glitch events
+	float late_max;
+	double late_sum;
+	int glitch;
+} latency;
+
+// latency of a sample from the ADC conversion to the socket write, per stage
+static struct {
+	t_hist conversion;		// conversion start to read
+	t_hist compute;			// read to filter update
+	t_hist queue;			// filter update to the output thread
+	t_hist output;			// formatting and write
+	t_hist total;
+} stages;
+
+// delay between connection attempts in us
+#define NMEA_RECONNECT_DELAY 1000000
+// backlog replayed on reconnect, roughly the last second of sentences
+#define NMEA_BACKLOG_SIZE 1024
+
+// output socket, sentences are kept in the queue while it is not connected
+static int nmea_sock = -1;
+static int nmea_connected = 0;
+static t_outq nmea_queue;
+static t_reactor_timer reconnect_timer;
+static void nmea_disconnect(void);
+
+// rate of the NMEA sentences
+static t_decim decim_E, decim_P_Q, decim_V;
+
+// server mode
+static t_server nmea_server;
+
+// binary output stream
+static t_server binary_server;
+static int binary_open = 0;
+
+// shared memory publication of the latest air data
+static t_airdata_shm *airdata_shm = NULL;
+static t_airdata airdata;
+
+static void print_tick_stats(void)
+{
+	if (sensor_tick.ticks == 0) return;
+	fprintf(stderr, "Sensor ticks: %lu, missed: %lu, lateness avg: %.0f us, max: %.0f us, dropped samples: %lu\n",
+		sensor_tick.ticks, sensor_tick.missed, sensor_tick.late_sum/sensor_tick.ticks, sensor_tick.late_max,
+		atomic_load(&sample_ring.dropped));
+	i2cbus_print_stats(stderr);
+}
+
 /**
 * @brief Signal handler if sensord will be interrupted
 * @param sig_num
@@ -90,126 +207,301 @@ static void sigintHandler(int sig_num)
 	// if meas_mode = record -> close fp now
 	if (fp_datalog != NULL)
 		fclose(fp_datalog);
+	if (fp_rawlog != NULL)
+		fclose(fp_rawlog);
 
 	// if sensordata from file
 	if (fp_sensordata != NULL)
 		fclose(fp_sensordata);
 
+	print_tick_stats();
 	fprintf(stderr, "Exiting ...\n");
 
 	exit(0);
 }
 
 
+/**
+* @brief Send the NMEA sentences of a tick without blocking
+* @param sock Network socket handler
+* @param batch sentences of the tick
+* @return result, negative if the connection failed
+*
+* All sentences go out with a single write. Whatever the socket doesn't
+* accept is queued and written once the socket becomes writable, so a slow
+* consumer never delays the sensor tick. While XCSoar is not connected the
+* most recent sentences are kept for replay on reconnect.
+* @date 18.10.2026 born
+*
+*/
+static int NMEA_write(int sock, const t_outq_batch *batch)
+{
+	int pending = outq_pending(&nmea_queue);
+
+	if (batch->len == 0) return 0;
+	if (g_listen_port) {
+		server_send(&nmea_server, batch->buf, batch->len);
+		return 0;
+	}
+	if (!nmea_connected) {
+		outq_append(&nmea_queue, batch->buf, batch->len);
+		return 0;
+	}
+	if (outq_write(&nmea_queue, sock, batch->buf, batch->len) < 0) return -1;
+
+	// wait for the socket to become writable
+	if (!pending && outq_pending(&nmea_queue))
+		reactor_modify_fd(&reactor, sock, EPOLLOUT|EPOLLRDHUP);
+	return 0;
+}
+
+/**
+* @brief Collect the latency of a sample which was just written
+* @param sample
+* @param t_out when the output thread picked the sample up
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+static void stages_report(const t_sample *sample, const struct timespec *t_out)
+{
+	struct timespec now;
+
+	// the first sample has no conversion start
+	if (sample->t_conv.tv_sec == 0)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	hist_add(&stages.conversion, &now, timespec_delta_us(&sample->t_read, &sample->t_conv));
+	hist_add(&stages.compute, &now, timespec_delta_us(&sample->time, &sample->t_read));
+	hist_add(&stages.queue, &now, timespec_delta_us(t_out, &sample->time));
+	hist_add(&stages.output, &now, timespec_delta_us(&now, t_out));
+	hist_add(&stages.total, &now, timespec_delta_us(&now, &sample->t_conv));
+}
+
+// dump the latency histograms on SIGUSR1
+static void stats_signal_handler(void *ctx, uint32_t events)
+{
+	struct signalfd_siginfo si;
+	struct timespec now;
+	int fd = *(int *)ctx;
+
+	(void)events;
+
+	while (read(fd, &si, sizeof(si)) == sizeof(si));
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	fprintf(stderr, "Latency of written samples:\n");
+	hist_print(&stages.conversion, &now, stderr);
+	hist_print(&stages.compute, &now, stderr);
+	hist_print(&stages.queue, &now, stderr);
+	hist_print(&stages.output, &now, stderr);
+	hist_print(&stages.total, &now, stderr);
+	print_tick_stats();
+}
+
+// reserve room for a sentence at the end of the batch
+static char *NMEA_begin(t_outq_batch *batch)
+{
+	return outq_batch_reserve(batch, NMEA_MAX_LENGTH);
+}
+
 /**
 * @brief Command handler for NMEA messages
 * @param sock Network socket handler
+* @param sample latest sample from the acquisition thread
 * @return
 *
-* Message handler called by main-loop to generate timing of NMEA messages
+* Message handler called for every sample to generate timing of NMEA messages
 * @date 17.04.2014 born
 *
 */
-static int NMEA_message_handler(int sock)
+static int NMEA_message_handler(int sock, const t_sample *sample)
 {
 	// some local variables
 	float vario;
 	int sock_err = 0;
-	static int nmea_counter = 1;
+	static unsigned long nmea_counter = 1;
+	unsigned long tick;
+	float in[DECIM_MAX_VALUES], out[DECIM_MAX_VALUES];
+	struct timespec t_out;
 	int result;
-	char s[256];
+	t_outq_batch batch;
+	size_t len;
+	char *s;
 
-	if (temp_sensor.temp_valid) {
+	clock_gettime(CLOCK_MONOTONIC, &t_out);
+	outq_batch_init(&batch);
+
+	if (temp_sensor.temp_valid && ((s = NMEA_begin(&batch)) != NULL)) {
 		// Compose POV NMEA sentences
-		result=Compose_Temperature_POV(&s[0], temp_sensor.temperature);
+		result=Compose_Temperature_POV(s, &len, temp_sensor.temperature);
 		// fprintf(stderr, "temp: %f\n",temp_sensor.temperature);
 		// // NMEA sentence valid ?? Otherwise print some error !!
 		if (result != 1) fprintf(stderr, "POV Temperature NMEA Result = %d\n",result);
-		// Send NMEA string via socket to XCSoar send complete sentence including terminating '\0'
-		if ((sock_err = write(sock, s, strlen(s))) < 0) fprintf(stderr, "send failed %s\n",s);
+		outq_batch_commit(&batch, len);
+		temp_sensor.temp_valid = 0;
 	}
-	if (temp_sensor.humidity_valid) {
+	if (temp_sensor.humidity_valid && ((s = NMEA_begin(&batch)) != NULL)) {
 		// Compose POV NMEA sentences
-		result=Compose_Humidity_POV(&s[0], temp_sensor.humidity);
+		result=Compose_Humidity_POV(s, &len, temp_sensor.humidity);
 		// fprintf(stderr, "humid: %f\n",temp_sensor.humidity);
 		// NMEA sentence valid ?? Otherwise print some error !!
 		if (result != 1) fprintf(stderr, "POV Humidity NMEA Result = %d\n",result);
-		// Send NMEA string via socket to XCSoar send complete sentence including terminating '\0'
-		if ((sock_err = write(sock, s, strlen(s))) < 0) fprintf(stderr, "send failed %s\n",s);
+		outq_batch_commit(&batch, len);
+		temp_sensor.humidity_valid = 0;
 	}
 
-	if ((nmea_counter++)%4==0)
-	{
-		// Compute Vario
-		vario = ComputeVario(vkf.x_abs_, vkf.x_vel_);
+	// each sentence at its own rate
+	tick = nmea_counter++;
 
-		if (config.output_POV_P_Q == 1)
+	in[0] = sample->p_static;
+	in[1] = sample->p_dynamic;
+	if ((config.output_POV_P_Q == 1) && decim_step(&decim_P_Q, tick, in, out, 2) && ((s = NMEA_begin(&batch)) != NULL))
+	{
+		// Compose POV slow NMEA sentences
+		result = Compose_Pressure_POV_slow(s, &len, out[0]/100, out[1]*100);
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
 		{
-			// Compose POV slow NMEA sentences
-			result = Compose_Pressure_POV_slow(&s[0], p_static/100, p_dynamic*100);
-			// NMEA sentence valid ?? Otherwise print some error !!
-			if (result != 1)
-			{
-				fprintf(stderr, "POV slow NMEA Result = %d\n",result);
-			}
-			// Send NMEA string via socket to XCSoar
-			if ((sock_err = write(sock, s, strlen(s))) < 0)
-			{
-			  fprintf(stderr, "send failed %s\n",s);
-				return sock_err;
-			}
+			fprintf(stderr, "POV slow NMEA Result = %d\n",result);
 		}
+		outq_batch_commit(&batch, len);
+	}
 
-		if (config.output_POV_E == 1)
+	// Compute Vario
+	in[0] = ComputeVario(sample->x_abs, sample->x_vel);
+	if ((config.output_POV_E == 1) && decim_step(&decim_E, tick, in, out, 1) && ((s = NMEA_begin(&batch)) != NULL))
+	{
+		vario = out[0];
+		if (sample->tep_valid != 1)
 		{
-			if (tep_sensor.valid != 1)
-			{
-				vario = 99;
-			}
-			// Compose POV slow NMEA sentences
-			result = Compose_Pressure_POV_fast(&s[0], vario);
-			// NMEA sentence valid ?? Otherwise print some error !!
-			if (result != 1)
-			{
-				fprintf(stderr, "POV fast NMEA Result = %d\n",result);
-			}
-			// Send NMEA string via socket to XCSoar
-			if ((sock_err = write(sock, s, strlen(s))) < 0)
-			{
-				fprintf(stderr, "send failed\n");
-				return sock_err;
-			}
+			vario = 99;
 		}
-
-		if (config.output_POV_V == 1 && voltage_sensor.present)
+		// Compose POV slow NMEA sentences
+		result = Compose_Pressure_POV_fast(s, &len, vario);
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
 		{
+			fprintf(stderr, "POV fast NMEA Result = %d\n",result);
+		}
+		outq_batch_commit(&batch, len);
+	}
 
-			// Compose POV slow NMEA sentences
-			result = Compose_Voltage_POV(&s[0], voltage_sensor.voltage_converted);
+	in[0] = sample->voltage;
+	if (config.output_POV_V == 1 && voltage_sensor.present && decim_step(&decim_V, tick, in, out, 1) && ((s = NMEA_begin(&batch)) != NULL))
+	{
 
-			// NMEA sentence valid ?? Otherwise print some error !!
-			if (result != 1)
-			{
-				fprintf(stderr, "POV voltage NMEA Result = %d\n",result);
-			}
-			// Send NMEA string via socket to XCSoar
-			if ((sock_err = write(sock, s, strlen(s))) < 0)
-			{
-			  fprintf(stderr, "send failed %s\n",s);
-				return sock_err;
-			}
+		// Compose POV slow NMEA sentences
+		result = Compose_Voltage_POV(s, &len, out[0]);
+
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
+		{
+			fprintf(stderr, "POV voltage NMEA Result = %d\n",result);
 		}
+		outq_batch_commit(&batch, len);
 	}
 
+	// Send NMEA strings of this tick via socket to XCSoar
+	if ((sock_err = NMEA_write(sock, &batch)) < 0) {
+		fprintf(stderr, "send failed\n");
+		metrics_count(&metrics.socket_errors);
+	} else if (batch.len)
+		stages_report(sample, &t_out);
+
 	return(sock_err);
 }
 
+// clock of the sensors, the simulated one runs at time_scale, a replay follows the recording
+static void sensor_clock(struct timespec *t)
+{
+	if (io_mode.sensordata_from_file)
+		*t = replay_tick.t_sensor;
+	else if (g_simulate)
+		i2csim_clock(t);
+	else
+		clock_gettime(CLOCK_MONOTONIC, t);
+}
+
+// AMS5915 counts of this tick
+static void dynamic_read(void)
+{
+	if (io_mode.rawdata_from_file) {
+		dynamic_sensor.digoutp = replay_tick.digoutp;
+		dynamic_sensor.digoutT = replay_tick.digoutT;
+	} else
+		ams5915_measure(&dynamic_sensor);
+}
+
+// MS5611 results of this tick, the raw words are kept in the sample before any compensation
+static void pressure_transfer(int a_temp, t_sample *sample)
+{
+	if (io_mode.rawdata_from_file)
+		ms5611_update(&tep_sensor, &static_sensor, a_temp, glitch_state.glitch, replay_tick.tep_adc, replay_tick.static_adc);
+	else
+		ms5611_transfer(&tep_sensor, &static_sensor, a_temp, glitch_state.glitch);
+
+	sample->tep_adc = a_temp ? tep_sensor.D2 : tep_sensor.D1;
+	sample->static_adc = a_temp ? static_sensor.D1 : static_sensor.D2;
+}
+
 /**
-* @brief Timming routine for pressure measurement
-* @param
+* @brief Wait until a replayed tick is due
+* @param t sensor clock of the tick
 * @return
 *
-* Timing handler to coordinate pressure measurement
+* The first tick is replayed at once, every later one when as much time
+* has passed as in the recording.
+* @date 18.10.2026 born
+*
+*/
+static void replay_pace(const struct timespec *t)
+{
+	static struct timespec start, first;
+	static int started = 0;
+	struct timespec now, deadline;
+	int64_t ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (!started) {
+		start = now;
+		first = *t;
+		started = 1;
+		return;
+	}
+
+	ns = (int64_t)(t->tv_sec - first.tv_sec) * 1000000000 + (t->tv_nsec - first.tv_nsec);
+	if (ns < 0)
+		return;
+	deadline.tv_sec = start.tv_sec + ns / 1000000000;
+	deadline.tv_nsec = start.tv_nsec + ns % 1000000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+
+	// a stall, e.g. waiting for XCSoar, is not made up at full speed
+	if (timespec_delta_s(&now, &deadline) > REPLAY_MAX_BEHIND) {
+		start = now;
+		first = *t;
+		return;
+	}
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+/**
+* @brief Timming routine for pressure measurement
+* @param late how late the sensor tick was serviced in us
+* @return 1 at the end of the replay file, 0 otherwise
+*
+* Timing handler to coordinate pressure measurement, runs in the acquisition thread.
+* The result of every tick is published to the output side as a sample.
+* A raw replay takes the ADC words, timestamps and lateness of each tick from
+* the recording and runs them through the same glitch compensation. The
+* Kalman filter steps by the recorded time, or by the nominal tick in the
+* pressure replay format. A paced replay waits for that time to pass.
 * @date 17.04.2014 born
 *
 * The MS5611 has been shown to have multiple different error modes.  The most common is that it is sensitive to timing jitter.  For reasons that are unknown, whenever the
@@ -224,125 +516,142 @@ static int NMEA_message_handler(int sock)
 * Rarely, other glitches have been seen where the temperature and/or pressure reading on one sensor just drops a substantial amount.  As such, any reading that is more than 100,000
 * away from the previous reading is rejected.
 */
-static void pressure_measurement_handler(void)
+static int pressure_measurement_handler(float late)
 {
-	static int meas_counter = 1, glitch = 0;
+	static int meas_counter = 1;
 	int reject = 0;
 	static struct timespec kalman_prev;
+	static struct timespec conv_start;
+	struct timespec t_read;
+	t_sample sample;
+	long glitch_before = glitch_state.glitch;
+	int overrun = 0;
+
+	memset(&sample, 0, sizeof(sample));
+	if (io_mode.rawdata_from_file) {
+		if (rawlog_read(fp_sensordata, &replay_tick))
+			return 1;
+		late = replay_tick.late;
+	} else if (io_mode.sensordata_from_file)
+		timespec_add_ns(&replay_tick.t_sensor, REPLAY_TICK_NS);
 
+	if (io_mode.sensordata_from_file && g_replay_paced)
+		replay_pace(&replay_tick.t_sensor);
 
 	// Initialize timers if first time through.
-	if (meas_counter==1) clock_gettime(CLOCK_MONOTONIC, &kalman_prev);
+	if (meas_counter==1) sensor_clock(&kalman_prev);
+
+	// a replay may start in the middle of a flight, or samples were dropped by a full ring while recording
+	if (io_mode.rawdata_from_file && (replay_tick.seq != (unsigned long)meas_counter)) {
+		if (meas_counter != 1)
+			fprintf(stderr, "Raw replay: ticks %d to %lu missing\n", meas_counter, replay_tick.seq - 1);
+		meas_counter = replay_tick.seq;
+	}
 
 	// read ADS1110
 	if (voltage_sensor.present && (meas_counter%4==0))
 	{
-		ads1110_measure(&voltage_sensor);
+		if (io_mode.rawdata_from_file)
+			voltage_sensor.voltage_raw = replay_tick.voltage_raw;
+		else
+			ads1110_measure(&voltage_sensor);
 		ads1110_calculate(&voltage_sensor);
 	}
 
-	if (!io_mode.sensordata_from_file)
+	if (!io_mode.sensordata_from_file || io_mode.rawdata_from_file)
 	{
-		static int glitchstart = 0, deltaxmax = 0, shutoff = 0;
-
 		// read AMS5915
-		ams5915_measure(&dynamic_sensor);
-
-		// if early, wait
+		dynamic_read();
 
 		// if more than 2ms late, increase the glitch counter
-
-		if ((sensor_wait(12500))>2000) { glitchstart=8; glitch+=8; }
+		if (late>2000) { glitch_state.glitchstart=8; glitch_state.glitch+=8; metrics_count(&metrics.ticks_late); }
 		if (meas_counter&1) {
 			// read pressure sensors
 			int deltax;
 
-			ms5611_read_temp(&tep_sensor,glitch);
-			ms5611_read_pressure(&static_sensor);
-			ms5611_start_pressure(&tep_sensor);
+			pressure_transfer(1, &sample);
+			clock_gettime(CLOCK_MONOTONIC, &t_read);
 			sensor_wait_mark();
-			ms5611_start_temp(&static_sensor);
 			if (abs((int)static_sensor.D1l-(int) static_sensor.D1)>100e3)  reject=1;
-			if (!glitch)
-				if (tep_sensor.D2l>tep_sensor.D2+300) { glitchstart=8; glitch=8; }
-			if (glitchstart) {
-				if (glitch>glitchstart)
+			if (!glitch_state.glitch)
+				if (tep_sensor.D2l>tep_sensor.D2+300) { glitch_state.glitchstart=8; glitch_state.glitch=8; }
+			if (glitch_state.glitchstart) {
+				if (glitch_state.glitch>glitch_state.glitchstart)
 					deltax=abs((int) tep_sensor.D2l-(int)tep_sensor.D2);
 				else
 					deltax=abs((int)tep_sensor.D2f-(int)tep_sensor.D2);
-				if (deltax>deltaxmax) deltaxmax=deltax;
-				if ((--glitchstart)==0) {
-					if (deltaxmax>15)
-						glitch += ((int) round(log((double)(deltaxmax)*config.timing_log)*config.timing_mult))+config.timing_off;
-					deltaxmax=0;
+				if (deltax>glitch_state.deltaxmax) glitch_state.deltaxmax=deltax;
+				if ((--glitch_state.glitchstart)==0) {
+					if (glitch_state.deltaxmax>15)
+						glitch_state.glitch += ((int) round(log((double)(glitch_state.deltaxmax)*config.timing_log)*config.timing_mult))+config.timing_off;
+					glitch_state.deltaxmax=0;
 				}
 			}
 
 			// if there was a glitch, compensate for the glitch
-			if (glitch) {
+			if (glitch_state.glitch) {
 				double correction,cor2;
 
-				if (--glitch>350) glitch=350;
-				if ((++shutoff)>399) {
-					shutoff=glitch=0;
+				if (--glitch_state.glitch>350) glitch_state.glitch=350;
+				if ((++glitch_state.shutoff)>399) {
+					glitch_state.shutoff=glitch_state.glitch=0;
+					overrun=1;
 					tep_sensor.D2f=tep_sensor.D2;
 					static_sensor.D2f=static_sensor.D2;
 				}
 				// compensate for the glitch
 				deltax = (int) tep_sensor.D2f-(int) tep_sensor.D2;
-				if (!glitchstart)
-					if (abs(deltax)<15) glitch=0;
+				if (!glitch_state.glitchstart)
+					if (abs(deltax)<15) glitch_state.glitch=0;
 				correction = deltax*deltax*static_sensor.comp2+deltax*static_sensor.comp1+static_sensor.comp0;
 				cor2=static_sensor.p*1e-5;
 				correction *= (cor2*cor2*static_sensor.Pcomp2+cor2*static_sensor.Pcomp1+static_sensor.Pcomp0);
 				static_sensor.D1+=(int) round(correction);
 			} else {
 				static_sensor.D1f=(static_sensor.D1f*7+static_sensor.D1)/8;
-				shutoff=0;
+				glitch_state.shutoff=0;
 			}
 			ms5611_calculate_pressure(&static_sensor);
 		} else {
 			// read pressure sensors
 			int deltax;
 
-			ms5611_read_pressure(&tep_sensor);
-			ms5611_read_temp(&static_sensor,glitch);
-			ms5611_start_temp(&tep_sensor);
+			pressure_transfer(0, &sample);
+			clock_gettime(CLOCK_MONOTONIC, &t_read);
 			sensor_wait_mark();
-			ms5611_start_pressure(&static_sensor);
 			if (abs((int) tep_sensor.D1l-(int) tep_sensor.D1)>100e3) reject=1;
-			if (!glitch)
-				if (static_sensor.D2l>static_sensor.D2+300) { glitchstart=8; glitch=8; }
-			if (glitchstart) {
-				if (glitch>glitchstart)
+			if (!glitch_state.glitch)
+				if (static_sensor.D2l>static_sensor.D2+300) { glitch_state.glitchstart=8; glitch_state.glitch=8; }
+			if (glitch_state.glitchstart) {
+				if (glitch_state.glitch>glitch_state.glitchstart)
 					deltax=abs((int) static_sensor.D2l-(int)static_sensor.D2);
 				else
 					deltax=abs((int)static_sensor.D2f-(int) static_sensor.D2);
-				if (deltax>deltaxmax) deltaxmax=deltax;
-				if ((--glitchstart)==0) {
-					if (deltaxmax>15)
-						glitch += ((int) round(log((double)(deltaxmax)*config.timing_log)*config.timing_mult))+config.timing_off;
-					deltaxmax=0;
+				if (deltax>glitch_state.deltaxmax) glitch_state.deltaxmax=deltax;
+				if ((--glitch_state.glitchstart)==0) {
+					if (glitch_state.deltaxmax>15)
+						glitch_state.glitch += ((int) round(log((double)(glitch_state.deltaxmax)*config.timing_log)*config.timing_mult))+config.timing_off;
+					glitch_state.deltaxmax=0;
 				}
 			}
 
 			// if there was a glitch, compensate for the glitch
-			if (glitch)
+			if (glitch_state.glitch)
 			{
 				double correction,cor2;
 
-				if (--glitch>350) glitch=350;
+				if (--glitch_state.glitch>350) glitch_state.glitch=350;
 				// compensate for the glitch
 				deltax = (int) static_sensor.D2f-(int) static_sensor.D2;
-				if (!glitchstart)
-					if (abs(deltax)<15) glitch=0;
+				if (!glitch_state.glitchstart)
+					if (abs(deltax)<15) glitch_state.glitch=0;
 				correction = deltax*deltax*tep_sensor.comp2+deltax*tep_sensor.comp1+tep_sensor.comp0;
 				cor2=tep_sensor.p*1e-5;
 				correction *= (cor2*cor2*tep_sensor.Pcomp2+cor2*tep_sensor.Pcomp1+tep_sensor.Pcomp0);
 				tep_sensor.D1+=(int) round(correction);
 			} else {
 				tep_sensor.D1f = (tep_sensor.D1f*7+tep_sensor.D1)/8;
-				shutoff=0;
+				glitch_state.shutoff=0;
 			}
 			ms5611_calculate_pressure(&tep_sensor);
 		}
@@ -351,11 +660,8 @@ static void pressure_measurement_handler(void)
 
 		// read from sensor data from file if desired
 		if (fscanf(fp_sensordata, "%f,%f,%f", &tep_sensor.p, &static_sensor.p, &dynamic_sensor.p) == EOF)
-		{
-			fprintf(stderr, "End of File reached\n");
-			fprintf(stderr, "Exiting ...\n");
-			exit(EXIT_SUCCESS);
-		}
+			return 1;
+		clock_gettime(CLOCK_MONOTONIC, &t_read);
 	}
 	// filtering
 	//
@@ -378,54 +684,137 @@ static void pressure_measurement_handler(void)
 			{
 				// tep pressure out of range
 				tep_sensor.valid = 0;
+				metrics_count(&metrics.tep_out_of_range);
 			} else {
 				// of tep pressure
 				struct timespec kalman_cur;
 
 				tep_sensor.valid=1;
-				clock_gettime(CLOCK_MONOTONIC, &kalman_cur);
+				sensor_clock(&kalman_cur);
 				KalmanFiler1d_update(&vkf, tep_sensor.p/100, 0.25, timespec_delta_s(&kalman_cur, &kalman_prev));
 				kalman_prev=kalman_cur;
 			}
-			if (io_mode.sensordata_to_file) {
-				if (tj)
-					fprintf(fp_datalog, "%.4f %.4f %f %u %u %u %u %u %u %u %u %d\n",tep_sensor.p,static_sensor.p,dynamic_sensor.p,static_sensor.D1,static_sensor.D1f,tep_sensor.D1,tep_sensor.D1f,static_sensor.D2,static_sensor.D2f,tep_sensor.D2,tep_sensor.D2f,glitch);
-				else fprintf(fp_datalog, "%.4f,%.4f,%.4f\n",tep_sensor.p,static_sensor.p,dynamic_sensor.p);
-			}
+			sample.record = io_mode.sensordata_to_file;
+		}
+	}
+
+	// glitch compensation and tick stats for the metrics
+	if (reject) metrics_count(&metrics.rejects);
+	if (!glitch_before && glitch_state.glitch) metrics_count(&metrics.glitches);
+	if (glitch_before && !glitch_state.glitch) metrics_count(overrun ? &metrics.overruns : &metrics.underruns);
+	metrics_set(&metrics.glitch, glitch_state.glitch);
+	metrics_set(&metrics.glitchstart, glitch_state.glitchstart);
+	metrics_set(&metrics.shutoff, glitch_state.shutoff);
+	metrics_set(&metrics.deltaxmax, glitch_state.deltaxmax);
+	metrics_count(&metrics.ticks);
+	if (late > 0) {
+		metrics_add(&metrics.late_sum_us, late);
+		if ((unsigned long)late > atomic_load_explicit(&metrics.late_max_us, memory_order_relaxed))
+			atomic_store_explicit(&metrics.late_max_us, late, memory_order_relaxed);
+	}
+
+	// publish the result of this tick
+	sample.seq = meas_counter;
+	clock_gettime(CLOCK_MONOTONIC, &sample.time);
+	sample.late = late;
+	// the transfer which read this result started the next conversion
+	sample.t_conv = conv_start;
+	sample.t_read = t_read;
+	sensor_clock(&sample.t_sensor);
+	conv_start = t_read;
+	sample.p_static = p_static;
+	sample.p_dynamic = p_dynamic;
+	sample.p_tep = tep_sensor.p;
+	sample.p_static_raw = static_sensor.p;
+	sample.p_dynamic_raw = dynamic_sensor.p;
+	sample.x_abs = vkf.x_abs_;
+	sample.x_vel = vkf.x_vel_;
+	sample.voltage = voltage_sensor.voltage_converted;
+	sample.static_D1 = static_sensor.D1;
+	sample.static_D1f = static_sensor.D1f;
+	sample.static_D2 = static_sensor.D2;
+	sample.static_D2f = static_sensor.D2f;
+	sample.tep_D1 = tep_sensor.D1;
+	sample.tep_D1f = tep_sensor.D1f;
+	sample.tep_D2 = tep_sensor.D2;
+	sample.tep_D2f = tep_sensor.D2f;
+	sample.digoutp = dynamic_sensor.digoutp;
+	sample.digoutT = dynamic_sensor.digoutT;
+	sample.voltage_raw = voltage_sensor.voltage_raw;
+	sample.glitch = glitch_state.glitch;
+	sample.glitchstart = glitch_state.glitchstart;
+	sample.deltaxmax = glitch_state.deltaxmax;
+	sample.shutoff = glitch_state.shutoff;
+	sample.p_abs_abs = vkf.p_abs_abs_;
+	sample.p_abs_vel = vkf.p_abs_vel_;
+	sample.p_vel_vel = vkf.p_vel_vel_;
+	sample.tep_valid = tep_sensor.valid;
+	sample.reject = reject;
+
+	if (io_mode.sensordata_from_file) {
+		// no real time constraints in replay, wait for the consumer
+		struct timespec nstime = {0,1e6};
+		while (ring_push(&sample_ring, &sample))
+			nanosleep(&nstime, NULL);
+	} else {
+		if (ring_push(&sample_ring, &sample)) {
+			atomic_fetch_add_explicit(&sample_ring.dropped, 1, memory_order_relaxed);
+			metrics_count(&metrics.samples_dropped);
+		}
+
+		if (config.snapshot_file[0] && (meas_counter%SNAPSHOT_PUBLISH_TICKS == 0)) {
+			t_snapshot snap;
+
+			snapshot_capture(&snap, &static_sensor, &tep_sensor, &glitch_state, &vkf);
+			snapshot_publish(&snapshot_slot, &snap);
 		}
 	}
+
 	meas_counter++;
+	return 0;
+}
+
+/**
+* @brief Run a step of the humidity sensor and schedule the next one
+* @param step humidity_start or humidity_step
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+static void humidity_cycle(int (*step)(t_ds2482 *, long *))
+{
+	long wait_us;
+
+	if (step(&temp_sensor, &wait_us) == HUM_PENDING)
+		reactor_arm_timer(&humidity_timer, wait_us);
+}
+
+static void humidity_timer_handler(void *ctx, uint32_t events)
+{
+	(void)ctx;
+	(void)events;
+
+	humidity_cycle(humidity_step);
 }
 
 static void temperature_measurement_handler(void)
 {
-	static int done = 0, temp_counter = 0, rollover=0;
+	static int done = 0, temp_counter = 0;
 
-	temp_sensor.temp_valid=temp_sensor.humidity_valid=0;
 	if (temp_sensor.temp_present|temp_sensor.humidity_present) {
 		switch (temp_sensor.sensor_type) {
 			case DS18B20 :
 				if (temp_sensor.temp_present) {
+					// the 1-Wire sequence advances by a few I2C operations per tick
 					if (temp_counter==0) {
-						if (OWReset(&temp_sensor)==1) { // Reset
-							if (OWWriteByte(&temp_sensor,0xCC)==1) { // Skip ROM
-								OWWriteByte(&temp_sensor,0x44); // Initiate Conversion
-							}
-						}
+						DS18B20StartConversion(&temp_sensor);
 						temp_counter=1;
 						done=0;
 					} else {
 						if (!done) {
-							if (OWReadByte(&temp_sensor)>0) {
-								if (OWReset(&temp_sensor)==1) {  // Reset
-									if (OWWriteByte(&temp_sensor,0xCC)==1) { // Skip ROM
-										if (OWWriteByte(&temp_sensor,0xBE)==1) { //Read Scratchpad
-											OWReadTemperature(&temp_sensor); // Convert output to temperature
-											done = temp_sensor.temp_valid+1;
-										}
-									}
-								}
-							}
+							if (DS18B20Poll(&temp_sensor)!=OW_PENDING)
+								done = temp_sensor.temp_valid+1;
 						}
 						if (++temp_counter>=temp_sensor.rollover) {
 							if (done) temp_counter=0;
@@ -434,67 +823,480 @@ static void temperature_measurement_handler(void)
 					}
 				}
 				break;
-			case AM2321 :
-				if (++temp_counter>=temp_sensor.rollover) {
-					if (!am2321_read(&temp_sensor)) done=temp_sensor.temp_valid+1;
-					temp_counter=0;
-				}
-				break;
-			case HTU21D :
-				if (temp_counter==0) {
-					if ((temp_sensor.humidity_present) && (rollover)) {
-						si7021_read_humidity(&temp_sensor);
-						fprintf(stderr, "Humidity: %f\n",temp_sensor.humidity);
-					}
-					if (temp_sensor.temp_present) si7021_start_temp(&temp_sensor);
-					if (temp_sensor.temp_valid) temp_sensor.compensate=1; else temp_sensor.compensate=0;
-				}
-				if (temp_counter==temp_sensor.rollover/2) {
-					if (temp_sensor.temp_present) {
-						si7021_read_temp(&temp_sensor);
-						fprintf(stderr, "Temperature: %f\n",temp_sensor.temperature);
-					}
-					if (temp_sensor.humidity_present) si7021_start_humidity(&temp_sensor);
-				}
-				if (++temp_counter>=temp_sensor.rollover) {
-					temp_counter=0;
-					rollover=1;
-				}
-				break;
-			case HTU31D : case SI7021 : case SHT4X : case SHT85 :
-				if (temp_counter==0) {
-					if (rollover) si7021_read_humidity(&temp_sensor);
-					si7021_start_humidity(&temp_sensor);
-				}
-				if (++temp_counter>=temp_sensor.rollover) {
-					temp_counter=0;
-					rollover=1;
-				}
+			case AM2321 : case HTU21D : case HTU31D : case SI7021 : case SHT4X : case SHT85 :
+				// conversion results are collected by humidity_timer
+				if (temp_counter==0) humidity_cycle(humidity_start);
+				if (++temp_counter>=temp_sensor.rollover) temp_counter=0;
 				break;
+		}
+	}
+}
+
+static void sensor_tick_handler(void *ctx, uint32_t events)
+{
+	static int j = 0;
+
+	(void)ctx;
+	(void)events;
+
+	ddebug_print("sensor tick %lu late %.0f us\n", sensor_tick.ticks, sensor_tick.late);
+	atomic_store_explicit(&metrics.ticks_missed, sensor_tick.missed, memory_order_relaxed);
+	if (pressure_measurement_handler(sensor_tick.late * time_scale)) {
+		// end of replay file
+		ring_close(&sample_ring);
+		reactor_stop(&acq_reactor);
+		return;
+	}
+
+	// delay the next tick
+	if (tj)
+		if ((++j)%1023==100) sensor_wait(250e3 / time_scale);
+}
+
+/**
+* @brief Acquisition thread
+* @param arg unused
+* @return
+*
+* Only does the pressure and voltage sensor I/O, glitch compensation and
+* filtering. Results are handed to the output side through sample_ring, so
+* output, recording and temperature polling never delay the sensor tick.
+* @date 18.10.2026 born
+*
+*/
+static void *acquisition_thread(void *arg)
+{
+	(void)arg;
+
+	// make sure the hot loop never takes a page fault on its stack
+	if (g_realtime)
+		rt_prefault_stack(RT_STACK_SIZE - 32*1024);
+
+	// the temperature filters were restored on a warm start
+	if (!warm_start) {
+		tep_sensor.D2f=tep_sensor.D2;
+		static_sensor.D2f=static_sensor.D2;
+	}
+
+	reactor_run(&acq_reactor);
+	return NULL;
+}
+
+/**
+* @brief Collect and report the wake-up latency of the sensor tick
+* @param sample
+* @return
+*
+* Every LATENCY_REPORT_INTERVAL seconds the latency against the 12.5ms
+* deadline and the number of glitch events are printed in real time or
+* debug mode.
+* @date 18.10.2026 born
+*
+*/
+static void latency_report(const t_sample *sample)
+{
+	if (latency.ticks == 0)
+		latency.start = sample->time;
+
+	latency.ticks++;
+	latency.late_sum += sample->late;
+	if (sample->late > latency.late_max) latency.late_max = sample->late;
+	if (sample->late > 2000) latency.late++;
+	if (sample->glitch && !latency.glitch) latency.glitches++;
+	latency.glitch = sample->glitch;
+
+	if (timespec_delta_s(&sample->time, &latency.start) < LATENCY_REPORT_INTERVAL)
+		return;
+
+	if (g_realtime || g_debug)
+		fprintf(stderr, "Wake-up latency: %lu ticks, avg: %.0f us, max: %.0f us, >2ms: %lu, glitches: %lu\n",
+			latency.ticks, latency.late_sum/latency.ticks, latency.late_max, latency.late, latency.glitches);
+	latency.ticks = latency.late = latency.glitches = 0;
+	latency.late_max = 0;
+	latency.late_sum = 0;
+}
+
+/**
+* @brief Record a sample to the data log
+* @param sample
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+static void record_sample(const t_sample *sample)
+{
+	rawlog_write_pressure(fp_datalog, sample, tj);
+}
+
+/**
+* @brief Publish the state after a sample to shared memory
+* @param sample latest sample from the acquisition thread
+* @return
+*
+* Runs before the NMEA handler, which consumes the temperature and
+* humidity readings.
+* @date 18.10.2026 born
+*
+*/
+static void airdata_update(const t_sample *sample)
+{
+	int64_t time = (int64_t)sample->time.tv_sec * 1000000000 + sample->time.tv_nsec;
+
+	airdata.time = time;
+	airdata.tick = sample->seq;
+	airdata.flags &= ~(AIRDATA_TEP_VALID|AIRDATA_VOLTAGE_VALID);
+	if (sample->tep_valid == 1)
+		airdata.flags |= AIRDATA_TEP_VALID;
+	if (voltage_sensor.present)
+		airdata.flags |= AIRDATA_VOLTAGE_VALID;
+	airdata.vario = ComputeVario(sample->x_abs, sample->x_vel);
+	airdata.p_static = sample->p_static;
+	airdata.p_tep = sample->p_tep;
+	airdata.p_dynamic = sample->p_dynamic*100;
+	airdata.voltage = sample->voltage;
 
+	if (temp_sensor.temp_valid) {
+		airdata.temperature = temp_sensor.temperature;
+		airdata.temp_time = time;
+		airdata.flags |= AIRDATA_TEMP_VALID;
+	}
+	if (temp_sensor.humidity_valid) {
+		airdata.humidity = temp_sensor.humidity;
+		airdata.humidity_time = time;
+		airdata.flags |= AIRDATA_HUMIDITY_VALID;
+	}
+
+	// a sensor which stopped delivering leaves its last reading behind
+	if (time - airdata.temp_time > AIRDATA_TIMEOUT * 1000000000LL)
+		airdata.flags &= ~AIRDATA_TEMP_VALID;
+	if (time - airdata.humidity_time > AIRDATA_TIMEOUT * 1000000000LL)
+		airdata.flags &= ~AIRDATA_HUMIDITY_VALID;
+
+	airdata_publish(airdata_shm, &airdata);
+}
+
+// every sample goes to the clients of the binary stream
+static void binary_send(const t_sample *sample)
+{
+	uint8_t frame[BINFRAME_MAX_SIZE];
+	size_t len;
+
+	len = binframe_sample(frame, sample, ComputeVario(sample->x_abs, sample->x_vel));
+	server_send(&binary_server, (const char *)frame, len);
+}
+
+/**
+* @brief Report the throughput of a replay
+* @return
+*
+* Counted from the first sample taken by the output side, so waiting for
+* XCSoar is left out. Every sample went through acquisition, NMEA output
+* and the enabled recordings. The speed is compared with the time span of
+* the recorded samples.
+* @date 18.10.2026 born
+*
+*/
+static void replay_report(void)
+{
+	struct timespec now;
+	double s, recorded;
+
+	if (replay_stats.samples == 0)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	s = (now.tv_sec - replay_stats.start.tv_sec) + 1e-9 * (now.tv_nsec - replay_stats.start.tv_nsec);
+	recorded = (replay_stats.last.tv_sec - replay_stats.first.tv_sec) + 1e-9 * (replay_stats.last.tv_nsec - replay_stats.first.tv_nsec);
+	if (s <= 0)
+		return;
+	fprintf(stderr, "Replay: %lu samples in %.3f s, %.0f samples/s, %.3f s recorded, %.1f times real time\n",
+		replay_stats.samples, s, replay_stats.samples / s, recorded, recorded / s);
+}
+
+static void sample_handler(void *ctx, uint32_t events)
+{
+	t_sample sample;
+	int eof;
+
+	(void)ctx;
+	(void)events;
+
+	ring_clear_notify(&sample_ring);
+	do {
+		eof = ring_eof(&sample_ring);
+		while (ring_pop(&sample_ring, &sample)) {
+			if (replay_stats.samples++ == 0) {
+				clock_gettime(CLOCK_MONOTONIC, &replay_stats.start);
+				replay_stats.first = sample.t_sensor;
+			}
+			replay_stats.last = sample.t_sensor;
+			latency_report(&sample);
+			if (sample.record)
+				record_sample(&sample);
+			if (io_mode.rawdata_to_file)
+				rawlog_write(fp_rawlog, &sample);
+			if (io_mode.binary_to_file)
+				recorder_push(&recorder, &sample);
+			if (airdata_shm != NULL)
+				airdata_update(&sample);
+			if (binary_open)
+				binary_send(&sample);
+			if (NMEA_message_handler(nmea_sock, &sample) < 0)
+				nmea_disconnect();
 		}
+	} while (eof != ring_eof(&sample_ring));
+
+	if (eof) {
+		fprintf(stderr, "End of File reached\n");
+		print_tick_stats();
+		replay_report();
+		fprintf(stderr, "Exiting ...\n");
+		exit(EXIT_SUCCESS);
 	}
 }
 
-static void handle_connection(int sock)
+static void temp_tick_handler(void *ctx, uint32_t events)
 {
-	int sock_err = 0;
-	int j = 0;
+	(void)ctx;
+	(void)events;
+
+	temperature_measurement_handler();
+}
 
-	tep_sensor.D2f=tep_sensor.D2;
-	static_sensor.D2f=static_sensor.D2;
+static void snapshot_tick_handler(void *ctx, uint32_t events)
+{
+	static int failed = 0;
+	t_snapshot snap;
+
+	(void)ctx;
+	(void)events;
+
+	if (snapshot_fetch(&snapshot_slot, &snap))
+		return;
+
+	// report only the first of a series of failures
+	if (snapshot_write(config.snapshot_file, &snap)) {
+		if (!failed)
+			fprintf(stderr, "Unable to write snapshot %s: %s\n", config.snapshot_file, strerror(errno));
+		failed = 1;
+	} else
+		failed = 0;
+}
+
+// replay waits for XCSoar, so no sentence is lost while connecting
+static uint32_t sample_ring_events(void)
+{
+	if (io_mode.sensordata_from_file && !g_inetd && !g_listen_port && !nmea_connected)
+		return 0;
+	return EPOLLIN;
+}
+
+/**
+* @brief Drop the connection to XCSoar and schedule the next attempt
+* @return
+*
+* Sampling carries on meanwhile, the queue now collects a backlog of the
+* most recent sentences. With inetd there is no reconnect, sensord exits.
+* @date 18.10.2026 born
+*
+*/
+static void nmea_disconnect(void)
+{
+	int connected = nmea_connected;
+
+	if (nmea_sock >= 0) {
+		reactor_remove_fd(&reactor, nmea_sock);
+		close(nmea_sock);
+	}
+	nmea_sock = -1;
+	nmea_connected = 0;
+
+	if (g_inetd) {
+		reactor_stop(&reactor);
+		return;
+	}
+
+	// backlog overruns are expected and not reported
+	if (connected && nmea_queue.dropped)
+		fprintf(stderr, "%lu NMEA updates dropped\n", nmea_queue.dropped);
+	// the rest of a partly written record belongs to the old stream
+	outq_init(&nmea_queue);
+	outq_config(&nmea_queue, NMEA_BACKLOG_SIZE, OUTQ_DROP_OLDEST);
+	reactor_modify_fd(&reactor, sample_ring.fd, sample_ring_events());
+	reactor_arm_timer(&reconnect_timer, NMEA_RECONNECT_DELAY);
+}
+
+// connection is up, replay the backlog
+static void nmea_connected_handler(void)
+{
+	int result;
+
+	nmea_connected = 1;
+	nmea_queue.dropped = 0;
+	metrics_count(&metrics.connects);
+	// a stalled XCSoar gets the latest values first once it reads again
+	outq_config(&nmea_queue, OUTQ_SIZE, OUTQ_DROP_OLDEST);
+	reactor_modify_fd(&reactor, sample_ring.fd, sample_ring_events());
+
+	result = outq_flush(&nmea_queue, nmea_sock);
+	if (result < 0) {
+		fprintf(stderr, "send failed\n");
+		metrics_count(&metrics.socket_errors);
+		nmea_disconnect();
+	} else
+		reactor_modify_fd(&reactor, nmea_sock, result ? EPOLLOUT|EPOLLRDHUP : EPOLLRDHUP);
+}
+
+static void socket_handler(void *ctx, uint32_t events)
+{
+	int result;
+	int err = 0;
+	socklen_t len = sizeof(err);
+
+	(void)ctx;
+
+	// outcome of a pending connect
+	if (!nmea_connected) {
+		if ((getsockopt(nmea_sock, SOL_SOCKET, SO_ERROR, &err, &len) < 0) || err || (events & (EPOLLERR|EPOLLHUP))) {
+			fprintf(stderr, "failed to connect, trying again\n");
+			metrics_count(&metrics.connect_failures);
+			nmea_disconnect();
+		} else
+			nmea_connected_handler();
+		return;
+	}
+
+	if (events & (EPOLLERR|EPOLLHUP|EPOLLRDHUP)) {
+		fprintf(stderr, "connection closed\n");
+		nmea_disconnect();
+		return;
+	}
+
+	if (events & EPOLLOUT) {
+		result = outq_flush(&nmea_queue, nmea_sock);
+		if (result < 0) {
+			fprintf(stderr, "send failed\n");
+			metrics_count(&metrics.socket_errors);
+			nmea_disconnect();
+		} else if (result == 0)
+			reactor_modify_fd(&reactor, nmea_sock, EPOLLRDHUP);
+	}
+}
+
+/**
+* @brief Start a non-blocking connect to XCSoar
+* @param ctx
+* @param events
+* @return
+*
+* Runs from the reconnect timer, the outcome is reported to socket_handler()
+* once the socket becomes writable.
+* @date 18.10.2026 born
+*
+*/
+static void reconnect_handler(void *ctx, uint32_t events)
+{
+	struct sockaddr_in server;
+
+	(void)ctx;
+	(void)events;
+
+	// output must never block the sensor tick
+	nmea_sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (nmea_sock < 0) {
+		fprintf(stderr, "could not create socket\n");
+		nmea_disconnect();
+		return;
+	}
+
+	memset(&server, 0, sizeof(server));
+	server.sin_addr.s_addr = inet_addr("127.0.0.1");
+	server.sin_family = AF_INET;
+	server.sin_port = htons(4353);
+
+	if ((connect(nmea_sock, (struct sockaddr *)&server, sizeof(server)) < 0) && (errno != EINPROGRESS)) {
+		fprintf(stderr, "failed to connect, trying again\n");
+		metrics_count(&metrics.connect_failures);
+		close(nmea_sock);
+		nmea_sock = -1;
+		nmea_disconnect();
+		return;
+	}
+
+	if (reactor_add_fd(&reactor, nmea_sock, EPOLLOUT|EPOLLRDHUP, REACTOR_PRIO_OUTPUT, socket_handler, NULL) != 0) {
+		close(nmea_sock);
+		nmea_sock = -1;
+		nmea_disconnect();
+	}
+}
+
+static void handle_connection(int sock)
+{
+	// output must never block the sensor tick
+	fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+	nmea_sock = sock;
+	nmea_connected = 1;
+	outq_init(&nmea_queue);
 
 	// main data acquisition loop
-	while(sock_err >= 0)
-	{
-		if (tj)
-			if ((++j)%1023==100) sensor_wait(250e3);
-		pressure_measurement_handler();
-		temperature_measurement_handler();
-		sock_err = NMEA_message_handler(sock);
-		//debug_print("Sock_err: %d\n",sock_err);
+	if (reactor_add_fd(&reactor, sock, EPOLLRDHUP, REACTOR_PRIO_OUTPUT, socket_handler, NULL) == 0) {
+		reactor_run(&reactor);
+		reactor_remove_fd(&reactor, sock);
+	}
 
+	if (nmea_queue.dropped)
+		fprintf(stderr, "%lu NMEA updates dropped\n", nmea_queue.dropped);
+	nmea_sock = -1;
+}
+
+// state of the pressure path for the header of a raw log
+static const t_rawlog_state *rawlog_state(void)
+{
+	static t_rawlog_state state;
+
+	state.glitch = glitch_state;
+	state.vkf = vkf;
+	state.p_static = p_static;
+	state.p_dynamic = p_dynamic;
+	state.warm_start = warm_start;
+	return &state;
+}
+
+// the writer thread empties its queue and closes the file with a trailer
+static void recorder_atexit(void)
+{
+	recorder_close(&recorder);
+}
+
+/**
+* @brief Start the binary recording
+* @return result
+*
+* Each file carries the raw log header, so recdump can turn a recording of
+* measured data into a raw replay file.
+* @date 18.10.2026 born
+*
+*/
+static int recorder_start(void)
+{
+	char state[RECORDER_ALIGN];
+	size_t len = 0;
+	FILE *fp;
+
+	if (!io_mode.sensordata_from_file || io_mode.rawdata_from_file) {
+		fp = fmemopen(state, sizeof(state), "w");
+		if (fp != NULL) {
+			rawlog_write_header(fp, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, rawlog_state());
+			len = ftell(fp);
+			fclose(fp);
+		}
 	}
+
+	if (recorder_open(&recorder, binlog_filename, config.record_format, config.record_file_size, state, len) != 0)
+		return 1;
+	atexit(recorder_atexit);
+	return 0;
 }
 
 int main (int argc, char **argv) {
@@ -505,6 +1307,8 @@ int main (int argc, char **argv) {
 
 	t_24c16 eeprom;
 	t_eeprom_data data;
+	t_snapshot snap;
+	t_rawlog_state replay_state;
 
 	// for daemonizing
 	pid_t pid;
@@ -512,9 +1316,14 @@ int main (int argc, char **argv) {
 
 	io_mode.sensordata_from_file = false;
 	io_mode.sensordata_to_file = false;
+	io_mode.rawdata_from_file = false;
+	io_mode.rawdata_to_file = false;
+	io_mode.binary_to_file = false;
 
 	// signals and action handlers
 	struct sigaction sigact;
+	sigset_t sigset;
+	int stats_fd;
 
 	// initialize variables
 	static_sensor.offset = 0.0;
@@ -527,6 +1336,11 @@ int main (int argc, char **argv) {
 
 	dynamic_sensor.offset = 0.0;
 	dynamic_sensor.linearity = 1.0;
+	dynamic_sensor.address = 0x28;
+	dynamic_sensor.bus = 1;
+
+	voltage_sensor.address = 0x48;
+	voltage_sensor.bus = 1;
 
 	tep_sensor.offset = 0.0;
 	tep_sensor.linearity = 1.0;
@@ -543,8 +1357,22 @@ int main (int argc, char **argv) {
 	config.timing_mult       = 50;
 	config.timing_off        = 12;
 	config.output_POV_E      = config.output_POV_P_Q = config.output_POV_T = config.output_POV_H = 0;
+	config.rate_E.rate       = config.rate_P_Q.rate = config.rate_V.rate = DECIM_DEFAULT_RATE;
+	config.rate_E.average    = config.rate_P_Q.average = config.rate_V.average = 0;
+	config.snapshot_file[0]  = '\0';
+	config.snapshot_max_age  = 60;
+	config.probe_cache[0]    = '\0';
+	config.client_queue_size = OUTQ_SIZE;
+	config.client_queue_policy = SERVER_DROP_OLDEST;
+	strcpy(config.listen_address, "127.0.0.1");
+	config.airdata_shm[0]    = '\0';
+	config.binary_port       = 0;
+	config.metrics_socket[0] = '\0';
+	config.record_file_size  = RECORDER_FILE_SIZE;
+	config.record_format     = RECORDER_FULL;
 
 	temp_sensor.rollover = temp_sensor.maxrollover = temp_sensor.databits = temp_sensor.sensor_type = temp_sensor.compensate = 0;
+	temp_sensor.bus = 1;
 
 	//parse command line arguments
 	cmdline_parser(argc, argv, &io_mode);
@@ -554,6 +1382,9 @@ int main (int argc, char **argv) {
 		cfgfile_parser(fp_config, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, &temp_sensor, &config);
 		fclose(fp_config);
 	}
+	decim_init(&decim_E, &config.rate_E);
+	decim_init(&decim_P_Q, &config.rate_P_Q);
+	decim_init(&decim_V, &config.rate_V);
 
 	// check if we are a daemon or stay in foreground
 	if (g_foreground)
@@ -612,13 +1443,29 @@ int main (int argc, char **argv) {
 	}
 
 	setbuf(stdout, NULL);
-	setbuf(stderr, NULL);
+	// the log thread writes whole lines
+	setvbuf(stderr, NULL, _IOLBF, 0);
 
 	// ignore SIGPIPE
 	signal(SIGPIPE, SIG_IGN);
 
+	// lock and pre-fault all memory before touching the sensors
+	if (g_realtime) {
+		if (rt_lock_memory() != 0)
+			fprintf(stderr, "Real time mode without locked memory !!\n");
+		rt_prefault_stack(RT_MAIN_STACK_PREFAULT);
+	}
+
+	// the simulated board replaces all I2C devices
+	if (g_simulate) {
+		if (i2csim_open(simulate_filename[0] ? simulate_filename : NULL) != 0)
+			return 1;
+		time_scale = i2csim_speed();
+	}
+
 	// get config from EEPROM
 	// open eeprom object
+	eeprom.bus = 1;
 	result = eeprom_open(&eeprom, 0x50);
 	if (result != 0)
 	{
@@ -637,7 +1484,21 @@ int main (int argc, char **argv) {
 		}
 	}
 
-	close(eeprom.fd);
+	i2cbus_close(&eeprom.dev);
+
+	// a replay of raw sensor words starts from the recorded sensor state
+	if (io_mode.sensordata_from_file) {
+		static_sensor.secordcomp = tep_sensor.secordcomp = g_secordcomp;
+		result = rawlog_read_header(fp_sensordata, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, &replay_state);
+		if (result < 0)
+			return 1;
+		io_mode.rawdata_from_file = (result == 0);
+		if (io_mode.rawdata_from_file) {
+			glitch_state = replay_state.glitch;
+			snap.vkf = replay_state.vkf;
+			warm_start = replay_state.warm_start;
+		}
+	}
 
 	// print runtime config
 	print_runtime_config();
@@ -646,7 +1507,7 @@ int main (int argc, char **argv) {
 	{
 		// we need hardware sensors for running !!
 		// open sensor for static pressure
-		if (ms5611_open(&static_sensor) != 0)
+		if (ms5611_open(&static_sensor, "MS5611 static") != 0)
 		{
 			fprintf(stderr, "Open static sensor failed !!\n");
 			return 1;
@@ -660,7 +1521,7 @@ int main (int argc, char **argv) {
 		static_sensor.valid = 1;
 
 		// open sensor for velocity pressure
-		if (ms5611_open(&tep_sensor) != 0)
+		if (ms5611_open(&tep_sensor, "MS5611 TE") != 0)
 		{
 			fprintf(stderr, "Open tep sensor failed !!\n");
 			return 1;
@@ -674,195 +1535,42 @@ int main (int argc, char **argv) {
 		tep_sensor.valid = 1;
 
 		// open sensor for differential pressure
-		/// @todo remove hardcoded i2c address for differential pressure
-		if (ams5915_open(&dynamic_sensor, 0x28) != 0)
+		if (ams5915_open(&dynamic_sensor, dynamic_sensor.address) != 0)
 		{
 			fprintf(stderr, "Open dynamic sensor failed !!\n");
 			return 1;
 		}
 
 		// open sensor for battery voltage
-		/// @todo remove hardcoded i2c address for voltage sensor
-		if (ads1110_open(&voltage_sensor, 0x48) != 0)
+		if (ads1110_open(&voltage_sensor, voltage_sensor.address) != 0)
 		{
 			fprintf(stderr, "Open voltage sensor failed !!\n");
 		}
 
 		// open temperature sensor and initialize
 		if (config.output_POV_T|config.output_POV_H) {
-			int autodetect=0,x=1;
-			switch (temp_sensor.sensor_type) {
-				case AUTO : fprintf(stderr, "Autodetecting temperature/humidity sensor\n");
-					    autodetect=1;
-					    // fallthrough
-				case DS18B20 :
-					if (!ds2482_open(&temp_sensor,0x18))
-						fprintf (stderr,"DS2482 interface failure !!\n");
-					else {
-						ds2482_reset(&temp_sensor);
-						if (OWConfigureBits(&temp_sensor)) {
-							temp_sensor.temp_present=config.output_POV_T;
-							temp_sensor.humidity_present=0;
-							fprintf(stderr, "DS18B20 temperature sensor present\n");
-							temp_sensor.sensor_type=DS18B20;
-							autodetect=0;
-							if (temp_sensor.rollover==0) {
-								temp_sensor.rollover=80;
-								temp_sensor.maxrollover=100;
-							}
-						} else {
-							if (!autodetect) fprintf (stderr,"Open DS18B20 sensor failed!\n");
-							else fprintf(stderr, "DS18B20 temperature sensor not detected\n");
-							close (temp_sensor.fd);
-						}
-					}
-					if (!autodetect) break;
-					// fallthrough
-				case AM2321 :
-					if (am2321_open(&temp_sensor,0x5c)) {
-						if (!autodetect) fprintf (stderr,"Open AM2321 temperature/humidity Sensor failed !!\n"); else
-						fprintf(stderr, "AM2321 temperature/humidity sensor not detected\n");
-						close(temp_sensor.fd);
-					} else {
-						fprintf(stderr, "AM2321 temperature/humidity sensor present\n");
-						temp_sensor.humidity_present=config.output_POV_H;
-						temp_sensor.temp_present=config.output_POV_T;
-						temp_sensor.sensor_type=AM2321;
-						if (temp_sensor.rollover==0) temp_sensor.rollover=160;
-						autodetect=0;
-					}
-					if (!autodetect) break;
-					// fallthrough
-				case SHT4X : case SHT85 :
-					switch (sht4x_open(&temp_sensor,0x45)) {
-						case 0 : fprintf(stderr, "sensor present\n");
-							 temp_sensor.humidity_present=config.output_POV_H;
-							 temp_sensor.temp_present=config.output_POV_T;
-							 if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-							 autodetect=0;
-							 x=0;
-							 break;
-						case 3 : fprintf(stderr, "SHT4X sensor may be detected on 0x45, but not working\n");
-							 fprintf (stderr,"SHT4X sensor may be detected on 0x45, but not working\n");
-							 close(temp_sensor.fd);
-							 break;
-						case 4 : if ((temp_sensor.sensor_type)==SHT4X) {
-								 fprintf(stderr, "SHT4X sensor detected on 0x45, but failed to read serial number\n");
-								 fprintf (stderr,"SHT4X sensor detected on 0x45, but failed to read serial nunber\n");
-							 }
-							 temp_sensor.humidity_present=config.output_POV_H;
-							 temp_sensor.temp_present=config.output_POV_T;
-							 if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-							 autodetect=0;
-							 break;
-						default :
-							close(temp_sensor.fd);
-							break;
-					}
-					if (x)
-						switch (sht4x_open(&temp_sensor,0x44)) {
-							case 0 : fprintf(stderr, "sensor present\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								 temp_sensor.temp_present=config.output_POV_T;
-								 if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								 autodetect=0;
-								 x=0;
-							break;
-							case 3 : fprintf(stderr, "SHT4X/SHT85 sensor may be detected on 0x44, but not working\n");
-								 fprintf (stderr,"SHT4X/SHT85 sensor may be detected on 0x44, but not working\n");
-								 close(temp_sensor.fd);
-								 break;
-							case 4 : if ((temp_sensor.sensor_type)==SHT4X) {
-									fprintf(stderr, "SHT4X sensor detected on 0x44, but failed to read serial number\n");
-									fprintf (stderr,"SHT4X sensor detected on 0x44, but failed to read serial nunber\n");
-								 } else {
-									fprintf(stderr, "SHT85 sensor detected, but failed to read serial number\n");
-									fprintf (stderr,"SHT85 sensor detected, but failed to read serial number\n");
-								 }
-								 temp_sensor.humidity_present=config.output_POV_H;
-								 temp_sensor.temp_present=config.output_POV_T;
-								 if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								 autodetect=0;
-								 break;
-							default : if (!autodetect) fprintf (stderr,"Open SHT4X/SHT85 temperature/humidity sensor failed !!\n"); else
-									  fprintf(stderr, "SHT4X/SHT85 tenperature/humidity sensor not detected\n");
-								close(temp_sensor.fd);
-						}
-					if (!autodetect) break;
-					// fallthrough
-				case SI7021 : case HTU21D : case HTU31D :
-					if ((temp_sensor.sensor_type!=HTU21D) && (temp_sensor.sensor_type!=SI7021)) {
-						switch (si7021_open(&temp_sensor,0x41)) {
-							case 0 : fprintf(stderr, "sensor present on 0x41\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								temp_sensor.temp_present=config.output_POV_T;
-								if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								autodetect=0;
-								x=0;
-								break;
-							case 3 : fprintf (stderr,"HTU31D may be detected on 0x41, but not working\n");
-								fprintf(stderr, "HTU31D sensor may be detected on 0x41, but not working\n");
-								close(temp_sensor.fd);
-								break;
-							case 4 : fprintf(stderr, "HTU31D sensor detected on 0x41, but failed to read serial number\n");
-								 fprintf (stderr,"HTU31D sensor detected on 0x41, but failed to read serial number\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								temp_sensor.temp_present=config.output_POV_T;
-								if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								autodetect=0;
-								break;
-							default :
-								close(temp_sensor.fd);
-								break;
-						}
+			int autodetect = (temp_sensor.sensor_type == AUTO);
+
+			if (autodetect) fprintf(stderr, "Autodetecting temperature/humidity sensor\n");
+			if (probe_temp_sensor(&temp_sensor, config.probe_cache[0] ? config.probe_cache : NULL) == 0) {
+				fprintf(stderr, "%s temperature/humidity sensor present on 0x%x\n", probe_type_name(temp_sensor.sensor_type), temp_sensor.address);
+				temp_sensor.temp_present=config.output_POV_T;
+				temp_sensor.humidity_present=(temp_sensor.sensor_type==DS18B20) ? 0 : config.output_POV_H;
+				if (temp_sensor.rollover==0) {
+					switch (temp_sensor.sensor_type) {
+						case DS18B20 : temp_sensor.rollover=80;
+							       temp_sensor.maxrollover=100;
+							       break;
+						case AM2321 : temp_sensor.rollover=160; break;
+						case HTU21D : temp_sensor.rollover=40; break;
+						default : temp_sensor.rollover=80; break;
 					}
-					if (x)
-						switch (si7021_open(&temp_sensor,0x40)) {
-							case 0 : fprintf(stderr, "sensor present on 0x40\n");
-								 temp_sensor.humidity_present=config.output_POV_H;
-								 temp_sensor.temp_present=config.output_POV_T;
-								 if (temp_sensor.rollover==0) {
-									 if (temp_sensor.sensor_type==HTU21D) temp_sensor.rollover=40; else temp_sensor.rollover=80;
-								 }
-								 autodetect=0;
-								 break;
-							case 3 : fprintf(stderr, "HTU31D sensor may be detected on 0x40, but not working\n");
-								 fprintf (stderr,"HTU31D sensor may be detected on 0x40, but not working\n");
-								 close(temp_sensor.fd);
-								 break;
-							case 4 : fprintf(stderr, "HTU31D sensor detected on 0x40, but failed to read serial number\n");
-								 fprintf (stderr,"HTU31D sensor detected on 0x40, but failed to read serial number\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								temp_sensor.temp_present=config.output_POV_T;
-								if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								autodetect=0;
-								break;
-							case 6 : fprintf(stderr, "SI7021/HTU21D detected but failed to read serial number\n");
-								fprintf (stderr, "SI7021/HTU21D detected but failed to read serial number\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								temp_sensor.temp_present=config.output_POV_T;
-								if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								autodetect=0;
-								break;
-							case 7 : fprintf(stderr, "failed to read firmware revision\n");
-								fprintf (stderr, "SI7021 detected but failed to read firmware revision\n");
-								temp_sensor.humidity_present=config.output_POV_H;
-								temp_sensor.temp_present=config.output_POV_T;
-								if (temp_sensor.rollover==0) temp_sensor.rollover=80;
-								autodetect=0;
-								break;
-							case 2 : case 5 : default :
-								if (!autodetect) fprintf (stderr,"Open SI7021/HTU21D/HTU31D temperature/humidity sensor failed !!\n"); else
-								fprintf(stderr, "SI7021/HTU21D/HTU31D tenperature/humidity sensor not detected\n");
-								close(temp_sensor.fd);
-						}
-					if (!autodetect) break;
-					// fallthrough
-				default :
-					config.output_POV_T=config.output_POV_H=0;
-					break;
-			}
-			if (autodetect) fprintf(stderr, "No temperature/humidity sensor detected !!\n");
+				}
+			} else if (autodetect) {
+				fprintf(stderr, "No temperature/humidity sensor detected !!\n");
+				config.output_POV_T=config.output_POV_H=0;
+			} else
+				fprintf(stderr, "Open %s temperature/humidity sensor failed !!\n", probe_type_name(temp_sensor.sensor_type));
 		}
 		//initialize differential pressure sensor
 		ams5915_init(&dynamic_sensor);
@@ -872,9 +1580,17 @@ int main (int argc, char **argv) {
 		// if(voltage_sensor.present)
 		ads1110_init(&voltage_sensor);
 
-		// poll sensors for offset compensation
+		// a recent snapshot of the same sensors replaces the warm-up
+		if (config.snapshot_file[0] && (snapshot_read(config.snapshot_file, &snap, config.snapshot_max_age) == 0)) {
+			if (snapshot_match(&snap, &static_sensor, &tep_sensor))
+				warm_start = 1;
+			else
+				fprintf(stderr, "Snapshot %s is from different sensors, ignored\n", config.snapshot_file);
+		}
+
+		// poll sensors for offset compensation, two readings to resume from a snapshot
 		tep_sensor.D2f=static_sensor.D2f=0;
-		for (i=0;i<120;++i)
+		for (i=0;i<(warm_start ? 2 : 120);++i)
 		{
 			ms5611_start_temp(&static_sensor);
 			ms5611_start_temp(&tep_sensor);
@@ -883,6 +1599,17 @@ int main (int argc, char **argv) {
 			sensor_wait_mark();
 			ms5611_read_temp(&static_sensor,0);
 			ms5611_read_temp(&tep_sensor,0);
+
+			// the live temperature has to match the snapshot, else warm up as usual
+			if (warm_start && !snapshot_plausible(&snap, &static_sensor, &tep_sensor)) {
+				fprintf(stderr, "Snapshot %s doesn't match the live temperature, ignored\n", config.snapshot_file);
+				warm_start = 0;
+			}
+		}
+
+		if (warm_start) {
+			ms5611_resume_temp(&static_sensor, snap.static_sensor.D2, snap.static_sensor.D2f);
+			ms5611_resume_temp(&tep_sensor, snap.tep_sensor.D2, snap.tep_sensor.D2f);
 		}
 
 		ms5611_start_pressure(&static_sensor);
@@ -907,10 +1634,27 @@ int main (int argc, char **argv) {
 		ams5915_measure(&dynamic_sensor);
 		ams5915_calculate(&dynamic_sensor);
 
+		if (warm_start) {
+			static_sensor.D1f = static_sensor.D1 + ((int64_t)snap.static_sensor.D1f - snap.static_sensor.D1);
+			tep_sensor.D1f = tep_sensor.D1 + ((int64_t)snap.tep_sensor.D1f - snap.tep_sensor.D1);
+			glitch_state = snap.glitch;
+		}
+
 		// initialize variables
 		p_static = static_sensor.p;
 		p_dynamic = dynamic_sensor.p;
 	}
+	else if (io_mode.rawdata_from_file)
+	{
+		ams5915_init(&dynamic_sensor);
+		ams5915_calculate(&dynamic_sensor);
+		ms5611_calculate_pressure(&static_sensor);
+		ms5611_calculate_pressure(&tep_sensor);
+		static_sensor.valid = tep_sensor.valid = dynamic_sensor.valid = 1;
+
+		p_static = replay_state.p_static;
+		p_dynamic = replay_state.p_dynamic;
+	}
 	else
 	{
 		p_static = 101325.0;
@@ -920,41 +1664,113 @@ int main (int argc, char **argv) {
 	// initialize kalman filter
 	KalmanFilter1d_reset(&vkf);
 	vkf.var_x_accel_ = config.vario_x_accel;
-	for(i=0; i < 1000; i++)
-		KalmanFiler1d_update(&vkf, tep_sensor.p/100, 0.25, 25e-3);
+	if (warm_start) {
+		// settled covariance and climb rate from the snapshot, altitude from the sensor
+		vkf = snap.vkf;
+		vkf.x_abs_ = tep_sensor.p/100;
+		vkf.var_x_accel_ = config.vario_x_accel;
+		if (!io_mode.sensordata_from_file)
+			fprintf(stderr, "Warm start from snapshot %s\n", config.snapshot_file);
+	} else
+		for(i=0; i < 1000; i++)
+			KalmanFiler1d_update(&vkf, tep_sensor.p/100, 0.25, 25e-3);
+
+	// a raw recording starts with the sensor state after warm-up and the settled filter
+	if (io_mode.rawdata_to_file) {
+		if (io_mode.sensordata_from_file && !io_mode.rawdata_from_file) {
+			fprintf(stderr, "No raw sensor data to record in a pressure replay\n");
+			io_mode.rawdata_to_file = false;
+		} else
+			rawlog_write_header(fp_rawlog, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, rawlog_state());
+	}
+
+	if (io_mode.binary_to_file)
+		if (recorder_start() != 0)
+			return 1;
+
+	// sensor tick, a replay is paced by the handler or runs as fast as possible
+	if (ring_init(&sample_ring) != 0)
+		return 1;
+	if (reactor_open(&acq_reactor) != 0)
+		return 1;
+	if (reactor_add_timer(&acq_reactor, &sensor_tick, io_mode.sensordata_from_file ? 0 : lrintf(12500 / time_scale), 0, REACTOR_PRIO_SENSOR, sensor_tick_handler, NULL) != 0)
+		return 1;
+
+	// output side, samples are drained first
+	if (reactor_open(&reactor) != 0)
+		return 1;
+	if (reactor_add_fd(&reactor, sample_ring.fd, sample_ring_events(), REACTOR_PRIO_SENSOR, sample_handler, NULL) != 0)
+		return 1;
+	// the temperature sensor is serviced half way between two sensor ticks
+	if (reactor_add_timer(&reactor, &temp_tick, 12500, 6250, REACTOR_PRIO_TEMP, temp_tick_handler, NULL) != 0)
+		return 1;
+	if (reactor_add_oneshot(&reactor, &humidity_timer, REACTOR_PRIO_TEMP, humidity_timer_handler, NULL) != 0)
+		return 1;
+	if (config.snapshot_file[0] && !io_mode.sensordata_from_file)
+		if (reactor_add_timer(&reactor, &snapshot_tick, SNAPSHOT_WRITE_INTERVAL*1000000L, 0, REACTOR_PRIO_OUTPUT, snapshot_tick_handler, NULL) != 0)
+			return 1;
+
+	// latency histograms are dumped on SIGUSR1, blocked before any thread is started
+	hist_init(&stages.conversion, "conversion");
+	hist_init(&stages.compute, "compute");
+	hist_init(&stages.queue, "queue");
+	hist_init(&stages.output, "output");
+	hist_init(&stages.total, "total");
+	sigemptyset(&sigset);
+	sigaddset(&sigset, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &sigset, NULL);
+
+	// debug output is written by a thread of its own from now on
+	if (log_start() != 0)
+		return 1;
+
+	stats_fd = signalfd(-1, &sigset, SFD_NONBLOCK|SFD_CLOEXEC);
+	if (stats_fd < 0) {
+		fprintf(stderr, "signalfd failed: %s\n", strerror(errno));
+		return 1;
+	}
+	if (reactor_add_fd(&reactor, stats_fd, EPOLLIN, REACTOR_PRIO_OUTPUT, stats_signal_handler, &stats_fd) != 0)
+		return 1;
+
+	if (config.airdata_shm[0])
+		airdata_shm = airdata_create(config.airdata_shm);
+	if (config.metrics_socket[0])
+		if (metrics_open(&reactor, config.metrics_socket) != 0)
+			return 1;
+	if (config.binary_port > 0) {
+		if (server_open(&binary_server, &reactor, "binary", config.listen_address, config.binary_port, config.client_queue_size, config.client_queue_policy) != 0)
+			return 1;
+		binary_open = 1;
+	}
+
+	if (g_realtime) {
+		if (rt_thread_create(&acquisition, acquisition_thread, NULL, g_rt_priority, g_rt_cpu) != 0)
+			return 1;
+	} else if (pthread_create(&acquisition, NULL, acquisition_thread, NULL) != 0) {
+		fprintf(stderr, "Unable to start acquisition thread !!\n");
+		return 1;
+	}
 
 	if (g_inetd) {
 		handle_connection(STDIN_FILENO);
 		return EXIT_SUCCESS;
 	}
 
-	while(1)
-	{
-		// socket communication
-		int sock;
-		struct sockaddr_in server;
-
-		// Open Socket for TCP/IP communication
-		sock = socket(AF_INET, SOCK_STREAM, 0);
-		if (sock == -1) fprintf(stderr, "could not create socket\n");
-		server.sin_addr.s_addr = inet_addr("127.0.0.1");
-		server.sin_family = AF_INET;
-		server.sin_port = htons(4353);
-
-		// try to connect to XCSoar
-		while (connect(sock, (struct sockaddr *)&server, sizeof(server)) < 0)
-		{
-			fprintf(stderr, "failed to connect, trying again\n");
-			fflush(stdout);
-			sleep(1);
-		}
-
-		// socket connected
-		handle_connection(sock);
-
-		// connection dropped
-		close(sock);
+	if (g_listen_port) {
+		if (server_open(&nmea_server, &reactor, "NMEA", config.listen_address, g_listen_port, config.client_queue_size, config.client_queue_policy) != 0)
+			return 1;
+		reactor_run(&reactor);
+		server_close(&nmea_server);
+		return EXIT_SUCCESS;
 	}
+
+	// connect to XCSoar in the background, sampling starts right away
+	outq_init(&nmea_queue);
+	outq_config(&nmea_queue, NMEA_BACKLOG_SIZE, OUTQ_DROP_OLDEST);
+	if (reactor_add_oneshot(&reactor, &reconnect_timer, REACTOR_PRIO_OUTPUT, reconnect_handler, NULL) != 0)
+		return 1;
+	reconnect_handler(NULL, 0);
+	reactor_run(&reactor);
 	return 0;
 }
 
@@ -23,6 +23,18 @@ typedef struct
 {
 	char sensordata_to_file;
 	char sensordata_from_file;
+	char rawdata_to_file;
+	char rawdata_from_file;		// replay file holds raw sensor words
+	char binary_to_file;
 } t_io_mode;
 
+// glitch detection state of the pressure measurement handler
+typedef struct
+{
+	int glitch;
+	int glitchstart;
+	int deltaxmax;
+	int shutoff;
+} t_glitch;
+
 void print_runtime_config(void);
@@ -0,0 +1,147 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "metrics.h"
+#include "i2cbus.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// size of one exposition, written with a single send
+#define METRICS_BUFSIZE 8192
+
+t_metrics metrics;
+
+static int metrics_fd = -1;
+
+static void metrics_counter(FILE *fp, const char *name, const char *help, atomic_ulong *c)
+{
+	fprintf(fp, "# HELP sensord_%s %s\n# TYPE sensord_%s counter\nsensord_%s %lu\n",
+		name, help, name, name, atomic_load_explicit(c, memory_order_relaxed));
+}
+
+static void metrics_gauge(FILE *fp, const char *name, const char *help, long v)
+{
+	fprintf(fp, "# HELP sensord_%s %s\n# TYPE sensord_%s gauge\nsensord_%s %ld\n",
+		name, help, name, name, v);
+}
+
+/**
+* @brief Write all metrics in the Prometheus text exposition format
+* @param fp
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void metrics_write(FILE *fp)
+{
+	metrics_counter(fp, "ticks_total", "Sensor ticks serviced.", &metrics.ticks);
+	metrics_counter(fp, "ticks_late_total", "Sensor ticks serviced more than 2 ms late.", &metrics.ticks_late);
+	metrics_counter(fp, "ticks_missed_total", "Sensor ticks missed entirely.", &metrics.ticks_missed);
+	metrics_counter(fp, "tick_lateness_us_total", "Sum of the sensor tick lateness in us.", &metrics.late_sum_us);
+	metrics_gauge(fp, "tick_lateness_max_us", "Max. sensor tick lateness in us.", atomic_load_explicit(&metrics.late_max_us, memory_order_relaxed));
+	metrics_counter(fp, "glitches_total", "Glitch compensations started.", &metrics.glitches);
+	metrics_counter(fp, "glitch_underruns_total", "Glitch compensations ended as the sensors settled.", &metrics.underruns);
+	metrics_counter(fp, "glitch_overruns_total", "Glitch compensations cut off after 400 ticks.", &metrics.overruns);
+	metrics_counter(fp, "rejects_total", "MS5611 conversions rejected as more than 100000 off.", &metrics.rejects);
+	metrics_counter(fp, "tep_out_of_range_total", "TE pressure samples outside 100..1200 hPa.", &metrics.tep_out_of_range);
+	metrics_counter(fp, "samples_dropped_total", "Samples lost as the output thread fell behind.", &metrics.samples_dropped);
+	metrics_gauge(fp, "glitch", "Remaining ticks of the glitch compensation.", atomic_load_explicit(&metrics.glitch, memory_order_relaxed));
+	metrics_gauge(fp, "glitchstart", "Remaining ticks of the glitch detection.", atomic_load_explicit(&metrics.glitchstart, memory_order_relaxed));
+	metrics_gauge(fp, "shutoff", "Ticks since the glitch compensation started.", atomic_load_explicit(&metrics.shutoff, memory_order_relaxed));
+	metrics_gauge(fp, "deltaxmax", "Max. D2 deviation of the current glitch detection.", atomic_load_explicit(&metrics.deltaxmax, memory_order_relaxed));
+	metrics_counter(fp, "socket_errors_total", "Failed writes to XCSoar.", &metrics.socket_errors);
+	metrics_counter(fp, "connect_failures_total", "Failed connection attempts to XCSoar.", &metrics.connect_failures);
+	metrics_counter(fp, "connects_total", "Connections to XCSoar established.", &metrics.connects);
+	i2cbus_write_metrics(fp);
+}
+
+// every connection gets one exposition and is closed
+static void metrics_accept_handler(void *ctx, uint32_t events)
+{
+	char buf[METRICS_BUFSIZE];
+	FILE *fp;
+	size_t len;
+	int fd;
+
+	(void)ctx;
+	(void)events;
+
+	fd = accept4(metrics_fd, NULL, NULL, SOCK_NONBLOCK|SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	fp = fmemopen(buf, sizeof(buf), "w");
+	if (fp != NULL) {
+		metrics_write(fp);
+		len = ftell(fp);
+		fclose(fp);
+		if (send(fd, buf, len, MSG_NOSIGNAL) < 0) {}
+	}
+	close(fd);
+}
+
+/**
+* @brief Serve the metrics on a Unix socket
+* @param r reactor serving the socket
+* @param path socket path, a stale socket is replaced
+* @return result
+*
+* Try with: socat - UNIX-CONNECT:path
+*
+* @date 18.10.2026 born
+*
+*/
+int metrics_open(t_reactor *r, const char *path)
+{
+	struct sockaddr_un addr;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "metrics socket path %s too long\n", path);
+		return 1;
+	}
+
+	metrics_fd = socket(AF_UNIX, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+	if (metrics_fd < 0) {
+		fprintf(stderr, "could not create socket: %s\n", strerror(errno));
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	unlink(path);
+	if ((bind(metrics_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(metrics_fd, 4) < 0)) {
+		fprintf(stderr, "could not listen on %s: %s\n", path, strerror(errno));
+		close(metrics_fd);
+		return 1;
+	}
+
+	if (reactor_add_fd(r, metrics_fd, EPOLLIN, REACTOR_PRIO_OUTPUT, metrics_accept_handler, NULL) != 0) {
+		close(metrics_fd);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,73 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "reactor.h"
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+// Counters of sensord, exported in the Prometheus text format on a Unix
+// socket. Every counter has a single writer, the acquisition thread or the
+// output thread, so a relaxed load and store is enough to update it. The
+// I2C device stats are not part of it, they are copied under the bus lock.
+typedef struct {
+	// acquisition thread
+	atomic_ulong ticks;
+	atomic_ulong ticks_late;	// serviced more than 2 ms late
+	atomic_ulong ticks_missed;
+	atomic_ulong late_sum_us;
+	atomic_ulong late_max_us;
+	atomic_ulong glitches;		// start of a glitch compensation
+	atomic_ulong underruns;		// compensation ended as the sensors settled
+	atomic_ulong overruns;		// compensation cut off by the shutoff counter
+	atomic_ulong rejects;		// conversions more than 100000 off the previous one
+	atomic_ulong tep_out_of_range;
+	atomic_ulong samples_dropped;	// sample ring full
+	atomic_long glitch;		// current glitch state
+	atomic_long glitchstart;
+	atomic_long shutoff;
+	atomic_long deltaxmax;
+	// output thread
+	atomic_ulong socket_errors;
+	atomic_ulong connect_failures;
+	atomic_ulong connects;
+} t_metrics;
+
+extern t_metrics metrics;
+
+static inline void metrics_count(atomic_ulong *c)
+{
+	atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+static inline void metrics_add(atomic_ulong *c, unsigned long v)
+{
+	atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + v, memory_order_relaxed);
+}
+
+static inline void metrics_set(atomic_long *g, long v)
+{
+	atomic_store_explicit(g, v, memory_order_relaxed);
+}
+
+int metrics_open(t_reactor *, const char *);
+void metrics_write(FILE *);
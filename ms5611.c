@@ -18,52 +18,32 @@
 */
 
 #include "ms5611.h"
+#include "i2cbus.h"
 #include "log.h"
 
 #include <stdio.h>
 #include <stdint.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <math.h>
-#include <linux/i2c-dev.h>
-#include <limits.h>
-#include <fcntl.h>
-#include <errno.h>
 #include <string.h>
 #include <inttypes.h>
 
 /**
 * @brief Establish connection to MS5611 pressure sensor
 * @param sensor pointer to sensor instance
+* @param name of the sensor in the I2C stats, e.g. "MS5611 static"
 * @return result
 *
 * @date 24.03.2016 revised
 *
 */
-int ms5611_open(t_ms5611 *sensor)
+int ms5611_open(t_ms5611 *sensor, const char *name)
 {
-	// local variables
-	int fd;
-	char i2c_dev[PATH_MAX] = {0};
-	sprintf(i2c_dev, "/dev/i2c-%hhu", sensor->bus);
-
-	// try to open I2C Bus
-	fd = open(i2c_dev, O_RDWR);
-
-	if (fd < 0) {
-		fprintf(stderr, "Error opening %s: %s\n", i2c_dev, strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, sensor->address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// register sensor on its I2C bus
+	if (i2cbus_open(&sensor->dev, name, sensor->bus, sensor->address) != 0)
 		return 1;
-	}
 
-	if (g_debug > 0) fprintf(stderr, "Opened MS5611 on bus %s with address 0x%x\n", i2c_dev, sensor->address);
-
-	// assign file handle to sensor object
-	sensor->fd = fd;
+	if (g_debug > 0) fprintf(stderr, "Opened MS5611 on bus /dev/i2c-%hhu with address 0x%x\n", sensor->bus, sensor->address);
 	return (0);
 }
 
@@ -105,6 +85,26 @@ uint8_t crc4(uint16_t n_prom[])
 	return (n_rem ^ 0x0);
 }
 
+/**
+* @brief Take over the calibration coefficients of a MS5611
+* @param sensor pointer to sensor instance
+* @param prom PROM contents as read from the sensor
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void ms5611_load_prom(t_ms5611 *sensor, const uint16_t prom[8])
+{
+	sensor->C1s = prom[1] << 15;
+	sensor->C2s = prom[2] << 16;
+	sensor->C3  = prom[3];
+	sensor->C4  = prom[4];
+	sensor->C5s = prom[5] << 8;
+	sensor->C6  = prom[6];
+	memcpy(sensor->prom, prom, sizeof(sensor->prom));
+}
+
 /**
 * @brief Initialize MS5611 pressure sensor
 * @param sensor pointer to sensor instance
@@ -130,12 +130,12 @@ int ms5611_init(t_ms5611 *sensor)
 	{
 		// get calibration values
 		buf[0] = a;													// This is the register we want to read from
-		if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from
+		if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {								// Send register we want to read from
 			fprintf(stderr, "Error writing to i2c slave (write cal reg)\n");
 			return(1);
 		}
 		usleep(10000);
-		if (read(sensor->fd, buf, 2) != 2) {								// Read back data into buf[]
+		if (i2cbus_read(&sensor->dev, buf, 2) != 2) {								// Read back data into buf[]
 			fprintf(stderr, "Unable to read from slave (get cal reg)\n");
 			return(1);
 		}
@@ -159,12 +159,7 @@ int ms5611_init(t_ms5611 *sensor)
 		ddebug_print("WRONG !!!!\n");
 	}
 
-	sensor->C1s = prom[1] << 15;
-	sensor->C2s = prom[2] << 16;
-	sensor->C3  = prom[3];
-	sensor->C4  = prom[4];
-	sensor->C5s = prom[5] << 8;
-	sensor->C6  = prom[6];
+	ms5611_load_prom(sensor, prom);
 
 	// print calibration values if debug is enabled
 	ddebug_print("Calibration values:\n");
@@ -194,14 +189,14 @@ int ms5611_reset(t_ms5611 *sensor)
 
 	// clock out sensor
 	//buf[0] = 0x00;										// This is the register we want to read from
-	//if ((write(sensor->fd, buf, 1)) != 1) {				// Send register we want to read from
+	//if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {				// Send register we want to read from
 //		fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 	//	return(1);
 	//}
 
 	// reset sensor
 	buf[0] = 0x1E;										// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {				// Send register we want to read from
+	if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {				// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 		return(1);
 	}
@@ -224,7 +219,7 @@ int ms5611_start_temp(t_ms5611 *sensor)
 
 	// start conversion for D2
 	buf[0] = 0x58;										// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {				// Send register we want to read from
+	if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {				// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave (%s)\n", __func__);
 		return(1);
 	}
@@ -248,7 +243,7 @@ int ms5611_start_pressure(t_ms5611 *sensor)
 
 	// start conversion for D1
 	buf[0] = 0x48;													// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from
+	if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {								// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave: start conv: adr %x\n",sensor->address);
 		return(1);
 	}
@@ -256,6 +251,95 @@ int ms5611_start_pressure(t_ms5611 *sensor)
 	return(0);
 }
 
+// calculate dT, temperature and the compensation terms from D2f
+static void ms5611_compensate(t_ms5611 *sensor)
+{
+	int64_t OFF2=0;
+	int64_t SENS2=0;
+	int64_t T2=0;
+
+	// calculate dT and absolute temperature
+	sensor->dT = sensor->D2f - sensor->C5s;
+	sensor->temp = 2000 + (((int64_t)sensor->dT * sensor->C6) / 8388608);
+
+	// these calculations are copied from the data sheet
+	//OFF = C2 * 2**16 + (C4 * dT) / 2**7
+	//SENS = C1 * 2**15 + (C3 * dT) / 2**8
+	//P = (D1 * SENS / 2**21 - OFF) / 2**15
+
+	sensor->off = (sensor->C2s + (((int64_t)sensor->C4 * sensor->dT) >> 7));
+	sensor->sens = (sensor->C1s + (((int64_t)sensor->C3 * sensor->dT) >> 8));
+
+	if (sensor->secordcomp)
+	{
+		// second order correction
+		if (sensor->temp < 2000)
+		{
+			T2 = (sensor->dT * sensor->dT) >> 31;
+			OFF2 = 5 * ((int64_t)(sensor->temp - 2000) * (sensor->temp - 2000)) >> 1;
+			SENS2 = 5 * ((int64_t)(sensor->temp - 2000) * (sensor->temp - 2000)) >> 2;
+
+			if (sensor->temp < -1500)
+			{
+				OFF2 = OFF2 + 7 * ((int64_t)(sensor->temp + 1500) * (sensor->temp + 1500));
+				SENS2 = SENS2 + ((11 * ((int64_t)(sensor->temp + 1500) * (sensor->temp + 1500))) >> 1);
+			}
+
+			sensor->temp = sensor->temp - T2;
+			sensor->off = sensor->off - OFF2;
+			sensor->sens = sensor->sens - SENS2;
+		}
+	}
+}
+
+/**
+* @brief Update temperature compensation from a new D2 reading
+* @param sensor pointer to sensor instance
+* @param adc raw D2 value
+* @param glitch glitch counter, compensation data is only updated without glitch
+* @return
+*
+*/
+static void ms5611_update_temp(t_ms5611 *sensor, uint32_t adc, int glitch)
+{
+	// Put temperature readings together
+	sensor->D2l = sensor->D2;
+	sensor->D2 = adc;
+	if (glitch==0)
+		if ((sensor->D2<=sensor->D2l+100e3) && (sensor->D2l<=sensor->D2+300))
+		{
+			sensor->D2f = (sensor->D2f*7+sensor->D2)/8;
+			ms5611_compensate(sensor);
+		}
+
+
+	// debug print
+	ddebug_print("%s @ 0x%x: D2 = %u\n", __func__, sensor->address, sensor->D2);
+	ddebug_print("%s @ 0x%x: dT = %d\n", __func__, sensor->address, sensor->dT);
+	debug_print("%s @ 0x%x: temp = %d\n", __func__, sensor->address, sensor->temp);
+}
+
+/**
+* @brief Resume the temperature filter from a saved state
+* @param sensor pointer to sensor instance, D2 holds a fresh reading
+* @param D2 saved raw temperature
+* @param D2f saved filtered temperature
+* @return
+*
+* The saved filter value is shifted by the drift of the raw reading since
+* it was saved, so a snapshot taken at a different temperature still gives
+* a settled filter.
+*
+* @date 18.10.2026 born
+*
+*/
+void ms5611_resume_temp(t_ms5611 *sensor, uint32_t D2, uint32_t D2f)
+{
+	sensor->D2f = D2f + ((int64_t)sensor->D2 - D2);
+	sensor->D2l = sensor->D2;
+	ms5611_compensate(sensor);
+}
+
 /**
 * @brief Read temperature from MS5611 sensor
 * @param sensor pointer to sensor instance
@@ -268,72 +352,20 @@ int ms5611_read_temp(t_ms5611 *sensor, int glitch)
 {
 	//variables
 	uint8_t buf[10]={0x00};
-	//variables
-	//long d2;
-	int64_t OFF2=0;
-	int64_t SENS2=0;
-	int64_t T2=0;
 
 	// read result
 	buf[0] = 0x00;
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from
+	if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {								// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave(%s)\n", __func__);
 		return(1);
 	}
 
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	if (i2cbus_read(&sensor->dev, buf, 3) != 3) {								// Read back data into buf[]
 		fprintf(stderr, "Unable to read from slave(%s)\n", __func__);
 		return(1);
 	}
 
-	// Put temperature readings together
-	sensor->D2l = sensor->D2;
-	sensor->D2 = (buf[0] << 16) + (buf[1] << 8) + buf[2];
-	if (glitch==0)
-		if ((sensor->D2<=sensor->D2l+100e3) && (sensor->D2l<=sensor->D2+300))
-		{
-			sensor->D2f = (sensor->D2f*7+sensor->D2)/8;
-
-			// calculate dT and absolute temperature
-			sensor->dT = sensor->D2f - sensor->C5s;
-			sensor->temp = 2000 + (((int64_t)sensor->dT * sensor->C6) / 8388608);
-
-			// these calculations are copied from the data sheet
-			//OFF = C2 * 2**16 + (C4 * dT) / 2**7
-			//SENS = C1 * 2**15 + (C3 * dT) / 2**8
-			//P = (D1 * SENS / 2**21 - OFF) / 2**15
-
-			sensor->off = (sensor->C2s + (((int64_t)sensor->C4 * sensor->dT) >> 7));
-			sensor->sens = (sensor->C1s + (((int64_t)sensor->C3 * sensor->dT) >> 8));
-
-			if (sensor->secordcomp)
-			{
-				// second order correction
-				if (sensor->temp < 2000)
-				{
-					T2 = (sensor->dT * sensor->dT) >> 31;
-					OFF2 = 5 * ((int64_t)(sensor->temp - 2000) * (sensor->temp - 2000)) >> 1;
-					SENS2 = 5 * ((int64_t)(sensor->temp - 2000) * (sensor->temp - 2000)) >> 2;
-
-					if (sensor->temp < -1500)
-					{
-						OFF2 = OFF2 + 7 * ((int64_t)(sensor->temp + 1500) * (sensor->temp + 1500));
-						SENS2 = SENS2 + ((11 * ((int64_t)(sensor->temp + 1500) * (sensor->temp + 1500))) >> 1);
-					}
-
-					sensor->temp = sensor->temp - T2;
-					sensor->off = sensor->off - OFF2;
-					sensor->sens = sensor->sens - SENS2;
-				}
-			}
-		}
-
-
-	// debug print
-	ddebug_print("%s @ 0x%x: D2 = %u\n", __func__, sensor->address, sensor->D2);
-	ddebug_print("%s @ 0x%x: dT = %d\n", __func__, sensor->address, sensor->dT);
-	debug_print("%s @ 0x%x: temp = %d\n", __func__, sensor->address, sensor->temp);
-
+	ms5611_update_temp(sensor, (buf[0] << 16) + (buf[1] << 8) + buf[2], glitch);
 	return(0);
 }
 
@@ -353,12 +385,12 @@ int ms5611_read_pressure(t_ms5611 *sensor)
 
 	// read result
 	buf[0] = 0x00;
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from
+	if ((i2cbus_write(&sensor->dev, buf, 1)) != 1) {								// Send register we want to read from
 		fprintf(stderr, "Error writing to i2c slave: write Read result(%s)\n", __func__);
 		return(1);
 	}
 
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	if (i2cbus_read(&sensor->dev, buf, 3) != 3) {								// Read back data into buf[]
 		fprintf(stderr, "Unable to read from slave: read result(%s)\n", __func__);
 		return(1);
 	}
@@ -370,6 +402,90 @@ int ms5611_read_pressure(t_ms5611 *sensor)
 	return 0;
 }
 
+/**
+* @brief Read the results of two sensors and start their next conversions
+* @param a pointer to first sensor instance
+* @param b pointer to second sensor instance
+* @param a_temp if set sensor a reads temperature and starts pressure, sensor b the opposite
+* @param glitch glitch counter passed on to the temperature reading
+* @return result
+*
+* Both ADC reads and both conversion starts go out as one I2C_RDWR
+* transaction with repeated STARTs in between. This replaces six read/write
+* calls and keeps the two conversion starts as close together as the bus
+* allows. Sensors on different busses fall back to the single calls.
+*
+* @date 18.10.2026 born
+*
+*/
+int ms5611_transfer(t_ms5611 *a, t_ms5611 *b, int a_temp, int glitch)
+{
+	uint8_t cmd_read = 0x00;
+	uint8_t cmd_a = a_temp ? 0x48 : 0x58;
+	uint8_t cmd_b = a_temp ? 0x58 : 0x48;
+	uint8_t buf_a[3], buf_b[3];
+	int result = 0;
+
+	if (a->bus != b->bus) {
+		if (a_temp) {
+			result |= ms5611_read_temp(a, glitch);
+			result |= ms5611_read_pressure(b);
+			result |= ms5611_start_pressure(a);
+			result |= ms5611_start_temp(b);
+		} else {
+			result |= ms5611_read_pressure(a);
+			result |= ms5611_read_temp(b, glitch);
+			result |= ms5611_start_temp(a);
+			result |= ms5611_start_pressure(b);
+		}
+		return result;
+	}
+
+	i2cbus_begin(a->bus);
+	i2cbus_queue_write(&a->dev, &cmd_read, 1);
+	i2cbus_queue_read(&a->dev, buf_a, 3);
+	i2cbus_queue_write(&b->dev, &cmd_read, 1);
+	i2cbus_queue_read(&b->dev, buf_b, 3);
+	i2cbus_queue_write(&a->dev, &cmd_a, 1);
+	i2cbus_queue_write(&b->dev, &cmd_b, 1);
+	if (i2cbus_flush(a->bus) != 0) {
+		fprintf(stderr, "I2C transfer failed: adr %x %x (%s)\n", a->address, b->address, __func__);
+		return(1);
+	}
+
+	ms5611_update(a, b, a_temp, glitch, (buf_a[0] << 16) + (buf_a[1] << 8) + buf_a[2], (buf_b[0] << 16) + (buf_b[1] << 8) + buf_b[2]);
+	return(0);
+}
+
+/**
+* @brief Take over the ADC words of a transfer
+* @param a pointer to first sensor instance
+* @param b pointer to second sensor instance
+* @param a_temp if set sensor a has read temperature, sensor b pressure
+* @param glitch glitch counter passed on to the temperature reading
+* @param adc_a raw ADC word of sensor a
+* @param adc_b raw ADC word of sensor b
+* @return
+*
+* Split from ms5611_transfer(), so a raw replay feeds recorded words into
+* the same path as the bus.
+*
+* @date 18.10.2026 born
+*
+*/
+void ms5611_update(t_ms5611 *a, t_ms5611 *b, int a_temp, int glitch, uint32_t adc_a, uint32_t adc_b)
+{
+	if (a_temp) {
+		ms5611_update_temp(a, adc_a, glitch);
+		b->D1l = b->D1;
+		b->D1 = adc_b;
+	} else {
+		a->D1l = a->D1;
+		a->D1 = adc_a;
+		ms5611_update_temp(b, adc_b, glitch);
+	}
+}
+
 int ms5611_calculate_pressure(t_ms5611 *sensor)
 {
 	sensor->p_meas = (((sensor->D1 * sensor->sens) >> 21) - sensor->off) >> 11;
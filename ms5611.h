@@ -19,15 +19,18 @@
 
 #pragma once
 
+#include "i2cbus.h"
+
 #include <stdint.h>
 
 // variable definitions
 
 // define struct for MS5611 sensor
 typedef struct {
-	int fd;
+	t_i2cdev dev;
 	unsigned char address;
 	uint8_t bus;
+	uint16_t prom[8];
 	uint32_t C1s;
 	uint32_t C2s;
 	uint16_t C3;
@@ -63,10 +66,14 @@ int ms5611_init(t_ms5611 *);
 int ms5611_reset(t_ms5611 *);
 int ms5611_measure(t_ms5611 *);
 int ms5611_calculate(t_ms5611 *);
-int ms5611_open(t_ms5611 *);
+int ms5611_open(t_ms5611 *, const char *);
 
 int ms5611_calculate_pressure(t_ms5611 *);
 int ms5611_read_pressure(t_ms5611 *);
 int ms5611_read_temp(t_ms5611 *, int);
 int ms5611_start_temp(t_ms5611 *);
 int ms5611_start_pressure(t_ms5611 *);
+int ms5611_transfer(t_ms5611 *, t_ms5611 *, int, int);
+void ms5611_update(t_ms5611 *, t_ms5611 *, int, int, uint32_t, uint32_t);
+void ms5611_load_prom(t_ms5611 *, const uint16_t [8]);
+void ms5611_resume_temp(t_ms5611 *, uint32_t, uint32_t);
@@ -18,6 +18,7 @@
 */
 
 #include "nmea.h"
+#include "pov.h"
 #include "log.h"
 
 #include <stdio.h>
@@ -26,6 +27,7 @@
 /**
 * @brief Implements the $POV NMEA Sentence for pressure data
 * @param sentence char pointer for created string
+* @param length length of the sentence
 * @param static_pressure
 * @param dynamic_pressure
 * @param tek_pressure // not implemented yet !!
@@ -56,9 +58,9 @@
 *
 */
 
-int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynamic_pressure)
+int Compose_Pressure_POV_slow(char *sentence, size_t *length, float static_pressure, float dynamic_pressure)
 {
-	int length;
+	t_pov w;
 	int success = 1;
 
 	// check static_pressure input value for validity
@@ -76,11 +78,12 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 		success = 20;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,P,%+07.4f,Q,%+05.2f", static_pressure, (dynamic_pressure));
-
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\r\n", NMEA_checksum(sentence));
+	// compose NMEA String, same as "$POV,P,%+07.4f,Q,%+05.2f*%02X\r\n"
+	pov_begin(&w, sentence, 'P');
+	pov_fixed(&w, static_pressure, 7, 4, POV_PLUS);
+	pov_field(&w, 'Q');
+	pov_fixed(&w, dynamic_pressure, 5, 2, POV_PLUS);
+	*length = pov_end(&w);
 
 	//print sentence for debug
 	debug_print("POV slow NMEA sentence: %s\n", sentence);
@@ -90,6 +93,7 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 /**
 * @brief Implements the $POV NMEA Sentence for fast data
 * @param sentence char pointer for created string
+* @param length length of the sentence
 * @param TE vario
 * @return result
 *
@@ -111,9 +115,9 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 *
 */
 
-int Compose_Pressure_POV_fast(char *sentence, float te_vario)
+int Compose_Pressure_POV_fast(char *sentence, size_t *length, float te_vario)
 {
-	int length;
+	t_pov w;
 	int success = 1;
 
 	// check te_vario input value for validity
@@ -123,11 +127,10 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 		success = 10;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,E,%+05.4f", te_vario);
-
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\r\n", NMEA_checksum(sentence));
+	// compose NMEA String, same as "$POV,E,%+05.4f*%02X\r\n"
+	pov_begin(&w, sentence, 'E');
+	pov_fixed(&w, te_vario, 5, 4, POV_PLUS);
+	*length = pov_end(&w);
 
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
@@ -137,6 +140,7 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 /**
 * @brief Implements the $POV NMEA Sentence for voltage data
 * @param sentence char pointer for created string
+* @param length length of the sentence
 * @param Battery Voltage
 * @return result
 *
@@ -158,9 +162,9 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 *
 */
 
-int Compose_Voltage_POV(char *sentence, float voltage)
+int Compose_Voltage_POV(char *sentence, size_t *length, float voltage)
 {
-	int length;
+	t_pov w;
 	int success = 1;
 
 	// check voltage input value for validity
@@ -175,11 +179,10 @@ int Compose_Voltage_POV(char *sentence, float voltage)
 		success = 10;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,V,%+05.2f", voltage);
-
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\r\n", NMEA_checksum(sentence));
+	// compose NMEA String, same as "$POV,V,%+05.2f*%02X\r\n"
+	pov_begin(&w, sentence, 'V');
+	pov_fixed(&w, voltage, 5, 2, POV_PLUS);
+	*length = pov_end(&w);
 
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
@@ -189,6 +192,7 @@ int Compose_Voltage_POV(char *sentence, float voltage)
 /**
 * @brief Implements the $POV NMEA Sentence for temperature data
 * @param sentence char pointer for created string
+* @param length length of the sentence
 * @param Temperature
 * @return result
 *
@@ -210,9 +214,9 @@ int Compose_Voltage_POV(char *sentence, float voltage)
 *
 */
 
-int Compose_Temperature_POV(char *sentence, float temperature)
+int Compose_Temperature_POV(char *sentence, size_t *length, float temperature)
 {
-	int length;
+	t_pov w;
 	int success = 1;
 
  	// check voltage input value for validity
@@ -221,11 +225,10 @@ int Compose_Temperature_POV(char *sentence, float temperature)
  		success = 10;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,T,%+05.4f", temperature);
-
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\r\n", NMEA_checksum(sentence));
+	// compose NMEA String, same as "$POV,T,%+05.4f*%02X\r\n"
+	pov_begin(&w, sentence, 'T');
+	pov_fixed(&w, temperature, 5, 4, POV_PLUS);
+	*length = pov_end(&w);
 
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
@@ -235,6 +238,7 @@ int Compose_Temperature_POV(char *sentence, float temperature)
 /**
 * @brief Implements the $POV NMEA Sentence for humidity data
 * @param sentence char pointer for created string
+* @param length length of the sentence
 * @param Humidity
 * @return result
 *
@@ -256,9 +260,9 @@ int Compose_Temperature_POV(char *sentence, float temperature)
 *
 */
 
-int Compose_Humidity_POV(char *sentence, float humidity)
+int Compose_Humidity_POV(char *sentence, size_t *length, float humidity)
 {
-	int length;
+	t_pov w;
 	int success = 1;
 
 	// check voltage input value for validity
@@ -267,11 +271,10 @@ int Compose_Humidity_POV(char *sentence, float humidity)
 		success = 10;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,H,%05.4f", humidity);
-
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\r\n", NMEA_checksum(sentence));
+	// compose NMEA String, same as "$POV,H,%05.4f*%02X\r\n"
+	pov_begin(&w, sentence, 'H');
+	pov_fixed(&w, humidity, 5, 4, 0);
+	*length = pov_end(&w);
 
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
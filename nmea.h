@@ -20,11 +20,16 @@
 #ifndef NMEA_H
 #define NMEA_H
 
+// max. length of a sentence including the terminating '\0'
+#define NMEA_MAX_LENGTH 83
+
+#include <stddef.h>
+
 unsigned char NMEA_checksum(char *);
-int Compose_Pressure_POV_slow(char *, float, float);
-int Compose_Pressure_POV_fast(char *, float);
-int Compose_Voltage_POV(char *sentence, float voltage);
-int Compose_Temperature_POV(char *sentence, float temperature);
-int Compose_Humidity_POV(char *sentence, float temperature);
+int Compose_Pressure_POV_slow(char *, size_t *, float, float);
+int Compose_Pressure_POV_fast(char *, size_t *, float);
+int Compose_Voltage_POV(char *sentence, size_t *length, float voltage);
+int Compose_Temperature_POV(char *sentence, size_t *length, float temperature);
+int Compose_Humidity_POV(char *sentence, size_t *length, float temperature);
 
 #endif
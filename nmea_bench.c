@@ -0,0 +1,198 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Microbenchmark of the $POV formatter against the former sprintf path.
+// Checks that both produce the same sentences, then times them.
+// Build with "make nmea_bench", for the target with the cross compiler as CC.
+
+#include "nmea.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_VALUES 4096
+#define BENCH_ROUNDS 500
+
+typedef size_t (*t_compose)(char *, const float *);
+
+// former implementation
+static size_t sprintf_slow(char *s, const float *v)
+{
+	int length = sprintf(s, "$POV,P,%+07.4f,Q,%+05.2f", v[0], v[1]);
+	return length + sprintf(s + length, "*%02X\r\n", NMEA_checksum(s));
+}
+
+static size_t sprintf_fast(char *s, const float *v)
+{
+	int length = sprintf(s, "$POV,E,%+05.4f", v[2]);
+	return length + sprintf(s + length, "*%02X\r\n", NMEA_checksum(s));
+}
+
+static size_t sprintf_voltage(char *s, const float *v)
+{
+	int length = sprintf(s, "$POV,V,%+05.2f", v[3]);
+	return length + sprintf(s + length, "*%02X\r\n", NMEA_checksum(s));
+}
+
+static size_t sprintf_temperature(char *s, const float *v)
+{
+	int length = sprintf(s, "$POV,T,%+05.4f", v[4]);
+	return length + sprintf(s + length, "*%02X\r\n", NMEA_checksum(s));
+}
+
+static size_t sprintf_humidity(char *s, const float *v)
+{
+	int length = sprintf(s, "$POV,H,%05.4f", v[5]);
+	return length + sprintf(s + length, "*%02X\r\n", NMEA_checksum(s));
+}
+
+// formatter
+static size_t pov_slow(char *s, const float *v)
+{
+	size_t length;
+	Compose_Pressure_POV_slow(s, &length, v[0], v[1]);
+	return length;
+}
+
+static size_t pov_fast(char *s, const float *v)
+{
+	size_t length;
+	Compose_Pressure_POV_fast(s, &length, v[2]);
+	return length;
+}
+
+static size_t pov_voltage(char *s, const float *v)
+{
+	size_t length;
+	Compose_Voltage_POV(s, &length, v[3]);
+	return length;
+}
+
+static size_t pov_temperature(char *s, const float *v)
+{
+	size_t length;
+	Compose_Temperature_POV(s, &length, v[4]);
+	return length;
+}
+
+static size_t pov_humidity(char *s, const float *v)
+{
+	size_t length;
+	Compose_Humidity_POV(s, &length, v[5]);
+	return length;
+}
+
+static const struct {
+	const char *name;
+	t_compose ref;
+	t_compose pov;
+} sentences[] = {
+	{ "P,Q", sprintf_slow, pov_slow },
+	{ "E", sprintf_fast, pov_fast },
+	{ "V", sprintf_voltage, pov_voltage },
+	{ "T", sprintf_temperature, pov_temperature },
+	{ "H", sprintf_humidity, pov_humidity },
+};
+
+#define BENCH_SENTENCES ((int)(sizeof(sentences)/sizeof(sentences[0])))
+
+static float values[BENCH_VALUES][6];
+
+static float uniform(float lo, float hi)
+{
+	return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+// values in the valid range of each sentence, with some exact ties
+static void bench_values(void)
+{
+	int i;
+
+	srand(1);
+	for (i = 0; i < BENCH_VALUES; i++) {
+		values[i][0] = uniform(200, 1100);
+		values[i][1] = uniform(-50, 5000);
+		values[i][2] = uniform(-10, 10);
+		values[i][3] = uniform(10, 15);
+		values[i][4] = uniform(-40, 50);
+		values[i][5] = uniform(0, 100);
+		if ((i % 16) == 0) {
+			values[i][1] = (rand() % 2000) * 0.125f;
+			values[i][2] = (rand() % 2000 - 1000) * 0.03125f;
+		}
+	}
+	values[0][2] = -0.0f;
+	values[1][2] = -0.00001f;
+	values[2][5] = 0.0f;
+}
+
+static double bench_run(t_compose compose)
+{
+	struct timespec start, end;
+	char s[NMEA_MAX_LENGTH];
+	size_t sum = 0;
+	int r, i;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		for (i = 0; i < BENCH_VALUES; i++)
+			sum += compose(s, values[i]);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	// keep the result alive
+	if (sum == 0) fprintf(stderr, "no output\n");
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / ((double)BENCH_ROUNDS * BENCH_VALUES);
+}
+
+int main(void)
+{
+	char a[NMEA_MAX_LENGTH], b[NMEA_MAX_LENGTH];
+	double ref, pov;
+	int i, j, errors = 0;
+
+	g_debug = 0;
+	bench_values();
+
+	for (j = 0; j < BENCH_SENTENCES; j++)
+		for (i = 0; i < BENCH_VALUES; i++) {
+			size_t la = sentences[j].ref(a, values[i]);
+			size_t lb = sentences[j].pov(b, values[i]);
+
+			if ((la != lb) || (strcmp(a, b) != 0)) {
+				if (errors++ < 10)
+					fprintf(stderr, "Mismatch: %s != %s", a, b);
+			}
+		}
+	if (errors) {
+		fprintf(stderr, "%d mismatches\n", errors);
+		return 1;
+	}
+
+	printf("sentence   sprintf ns   pov ns   speedup\n");
+	for (j = 0; j < BENCH_SENTENCES; j++) {
+		ref = bench_run(sentences[j].ref);
+		pov = bench_run(sentences[j].pov);
+		printf("%-8s %10.1f %8.1f %8.2fx\n", sentences[j].name, ref, pov, ref / pov);
+	}
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "outq.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+void outq_init(t_outq *q)
+{
+	q->len = 0;
+	q->limit = OUTQ_SIZE;
+	q->policy = OUTQ_DROP_NEWEST;
+	q->nrec = 0;
+	q->partial = 0;
+	q->dropped = 0;
+}
+
+/**
+* @brief Set size limit and overflow policy
+* @param q pointer to output queue
+* @param limit max. pending bytes, OUTQ_BATCH_SIZE up to OUTQ_SIZE
+* @param policy OUTQ_DROP_NEWEST or OUTQ_DROP_OLDEST
+* @return
+*
+* The rest of a partly written record must always fit, so the queue holds
+* at least one batch.
+*
+* @date 18.10.2026 born
+*
+*/
+void outq_config(t_outq *q, size_t limit, int policy)
+{
+	if (limit == 0)
+		limit = OUTQ_SIZE;
+	q->limit = (limit < OUTQ_BATCH_SIZE) ? OUTQ_BATCH_SIZE : (limit < OUTQ_SIZE) ? limit : OUTQ_SIZE;
+	q->policy = policy;
+}
+
+// remove record i, the first record is never removed while it is partly written
+static void outq_drop(t_outq *q, int i)
+{
+	size_t offset = (i > 0) ? q->rec[0] : 0;
+	size_t len = q->rec[i];
+
+	memmove(q->buf + offset, q->buf + offset + len, q->len - offset - len);
+	q->len -= len;
+	memmove(&q->rec[i], &q->rec[i+1], (q->nrec - i - 1) * sizeof(q->rec[0]));
+	q->nrec--;
+	q->dropped++;
+}
+
+// make room for a record of len bytes
+static int outq_make_room(t_outq *q, size_t len)
+{
+	int first = q->partial ? 1 : 0;
+
+	while ((q->nrec == OUTQ_RECORDS) || (len > q->limit - q->len)) {
+		if ((q->policy != OUTQ_DROP_OLDEST) || (q->nrec <= first))
+			return 1;
+		outq_drop(q, first);
+	}
+	return 0;
+}
+
+// account for n bytes written from the head of the queue
+static void outq_consume(t_outq *q, size_t n)
+{
+	q->len -= n;
+	memmove(q->buf, q->buf + n, q->len);
+
+	while ((n > 0) && (q->nrec > 0)) {
+		if (n < q->rec[0]) {
+			q->rec[0] -= n;
+			q->partial = 1;
+			return;
+		}
+		n -= q->rec[0];
+		memmove(&q->rec[0], &q->rec[1], (q->nrec - 1) * sizeof(q->rec[0]));
+		q->nrec--;
+		q->partial = 0;
+	}
+}
+
+/**
+* @brief Queue a record without writing it
+* @param q pointer to output queue
+* @param data
+* @param len
+* @return 1 if the record was dropped, 0 otherwise
+*
+* If the queue is full either the new record is dropped, or the oldest
+* records which are not yet partly written.
+*
+* @date 18.10.2026 born
+*
+*/
+int outq_append(t_outq *q, const char *data, size_t len)
+{
+	if (outq_make_room(q, len) || (len > sizeof(q->buf) - q->len)) {
+		q->dropped++;
+		return 1;
+	}
+
+	memcpy(q->buf + q->len, data, len);
+	q->len += len;
+	q->rec[q->nrec++] = len;
+	return 0;
+}
+
+/**
+* @brief Write a record to a non-blocking socket, queue what doesn't fit
+* @param q pointer to output queue
+* @param fd socket
+* @param data
+* @param len
+* @return -1 on socket error, 1 if the record was dropped, 0 otherwise
+*
+* Data is only written directly if nothing is pending, so the order of the
+* stream is kept.
+*
+* @date 18.10.2026 born
+*
+*/
+int outq_write(t_outq *q, int fd, const char *data, size_t len)
+{
+	ssize_t n = 0;
+
+	if (q->len == 0) {
+		n = write(fd, data, len);
+		if (n < 0) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+				return -1;
+			n = 0;
+		}
+		data += n;
+		len -= n;
+	}
+
+	if (len == 0) return 0;
+
+	if (outq_append(q, data, len) != 0)
+		return 1;
+
+	// the rest of a partly written record
+	if (n > 0) q->partial = 1;
+	return 0;
+}
+
+/**
+* @brief Write pending data
+* @param q pointer to output queue
+* @param fd socket
+* @return -1 on socket error, 0 if everything is written, 1 if data is still pending
+*
+* @date 18.10.2026 born
+*
+*/
+int outq_flush(t_outq *q, int fd)
+{
+	ssize_t n;
+
+	if (q->len == 0) return 0;
+
+	n = write(fd, q->buf, q->len);
+	if (n < 0) {
+		if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+			return -1;
+		return 1;
+	}
+
+	outq_consume(q, n);
+	return (q->len != 0);
+}
@@ -0,0 +1,78 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OUTQ_SIZE 4096
+#define OUTQ_RECORDS 128
+#define OUTQ_BATCH_SIZE 512
+
+// what to drop if the queue is full
+#define OUTQ_DROP_NEWEST 0
+#define OUTQ_DROP_OLDEST 1
+
+// pending output for a non-blocking socket, every write is kept as a record
+// so only whole records are ever dropped
+typedef struct {
+	char buf[OUTQ_SIZE];
+	size_t len;
+	size_t limit;			// max. pending bytes
+	int policy;
+	uint16_t rec[OUTQ_RECORDS];	// length of the pending records
+	int nrec;
+	int partial;			// first record is partly written
+	unsigned long dropped;		// records dropped
+} t_outq;
+
+// output of one tick, composed in place and written with a single call
+typedef struct {
+	char buf[OUTQ_BATCH_SIZE];
+	size_t len;
+} t_outq_batch;
+
+void outq_init(t_outq *);
+void outq_config(t_outq *, size_t, int);
+int outq_append(t_outq *, const char *, size_t);
+int outq_write(t_outq *, int, const char *, size_t);
+int outq_flush(t_outq *, int);
+
+static inline size_t outq_pending(const t_outq *q)
+{
+	return q->len;
+}
+
+static inline void outq_batch_init(t_outq_batch *b)
+{
+	b->len = 0;
+}
+
+// space for up to len bytes at the end of the batch, NULL if it is full
+static inline char *outq_batch_reserve(t_outq_batch *b, size_t len)
+{
+	if (len > sizeof(b->buf) - b->len) return NULL;
+	return b->buf + b->len;
+}
+
+static inline void outq_batch_commit(t_outq_batch *b, size_t len)
+{
+	b->len += len;
+}
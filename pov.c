@@ -0,0 +1,150 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "pov.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+static const double pov_scale[] = { 1, 10, 100, 1000, 10000 };
+
+#define POV_MAX_PREC 4
+
+// longest value of the fixed-point path, 19 digits, point and sign, so two
+// fields always fit into NMEA_MAX_LENGTH
+#define POV_MAX_FIELD 21
+
+static inline void pov_putc(t_pov *w, char c)
+{
+	*w->p++ = c;
+	w->checksum ^= c;
+}
+
+/**
+* @brief Start a sentence
+* @param w pointer to writer
+* @param sentence buffer, at least NMEA_MAX_LENGTH bytes
+* @param code code of the first field
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void pov_begin(t_pov *w, char *sentence, char code)
+{
+	w->start = w->p = sentence;
+	w->checksum = 0;
+
+	// '$' is not part of the checksum
+	*w->p++ = '$';
+	pov_putc(w, 'P');
+	pov_putc(w, 'O');
+	pov_putc(w, 'V');
+	pov_field(w, code);
+}
+
+// append ",code"
+void pov_field(t_pov *w, char code)
+{
+	pov_putc(w, ',');
+	pov_putc(w, code);
+}
+
+/**
+* @brief Append ",value" in fixed-point notation
+* @param w pointer to writer
+* @param value
+* @param width min. field width, padded with zeros
+* @param prec digits after the decimal point, up to 4
+* @param flags POV_PLUS
+* @return
+*
+* The output is the same as printf("%0*.*f") with the given width and
+* precision. A float times 10^prec is exact in a double, so rint() rounds
+* it half to even just like printf does with the exact decimal value.
+*
+* @date 18.10.2026 born
+*
+*/
+void pov_fixed(t_pov *w, float value, int width, int prec, int flags)
+{
+	char digits[24];
+	uint64_t n;
+	int len = 0, total, i;
+
+	pov_putc(w, ',');
+
+	// rare, not worth a fast path, cut to the length of a fixed-point value
+	if (!isfinite(value) || (fabsf(value) >= 1e15f) || (prec < 0) || (prec > POV_MAX_PREC)) {
+		char tmp[POV_MAX_FIELD + 1];
+
+		snprintf(tmp, sizeof(tmp), (flags & POV_PLUS) ? "%+0*.*f" : "%0*.*f", width, prec, value);
+		for (i = 0; tmp[i] != '\0'; i++)
+			pov_putc(w, tmp[i]);
+		return;
+	}
+
+	n = (uint64_t)rint(fabs((double)value) * pov_scale[prec]);
+
+	// digits in reverse order, at least one in front of the point
+	do {
+		digits[len++] = '0' + n % 10;
+		n /= 10;
+	} while ((n != 0) || (len <= prec));
+
+	total = len + (prec > 0);
+	if (signbit(value)) {
+		pov_putc(w, '-');
+		total++;
+	} else if (flags & POV_PLUS) {
+		pov_putc(w, '+');
+		total++;
+	}
+	for (i = total; i < width; i++)
+		pov_putc(w, '0');
+
+	for (i = len - 1; i >= 0; i--) {
+		pov_putc(w, digits[i]);
+		if ((i == prec) && (prec > 0))
+			pov_putc(w, '.');
+	}
+}
+
+/**
+* @brief Append checksum and line end
+* @param w pointer to writer
+* @return length of the sentence without the terminating '\0'
+*
+* @date 18.10.2026 born
+*
+*/
+size_t pov_end(t_pov *w)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	*w->p++ = '*';
+	*w->p++ = hex[w->checksum >> 4];
+	*w->p++ = hex[w->checksum & 0xf];
+	*w->p++ = '\r';
+	*w->p++ = '\n';
+	*w->p = '\0';
+	return w->p - w->start;
+}
@@ -0,0 +1,38 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+// flags of pov_fixed()
+#define POV_PLUS 1		// always print a sign, like the '+' flag of printf
+
+// writer for a $POV sentence, the checksum is computed while writing
+typedef struct {
+	char *start;
+	char *p;			// next character
+	unsigned char checksum;
+} t_pov;
+
+void pov_begin(t_pov *, char *, char);
+void pov_field(t_pov *, char);
+void pov_fixed(t_pov *, float, int, int, int);
+size_t pov_end(t_pov *);
@@ -0,0 +1,272 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "probe.h"
+#include "humidity.h"
+#include "clock.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+static int ds18b20_probe(t_ds2482 *, unsigned char, long *);
+
+// in order of preference if more than one sensor is found
+static const t_probe_candidate candidates[] = {
+	{ DS18B20, 0x18, "DS18B20", ds18b20_probe, NULL, 1u<<0 },
+	{ AM2321, 0x5c, "AM2321", am2321_wakeup, am2321_identify, 1u<<0 },
+	{ SHT4X, 0x45, "SHT4x/SHT85", sht4x_reset, sht4x_identify, (1u<<0)|(1u<<4) },
+	{ SHT4X, 0x44, "SHT4x/SHT85", sht4x_reset, sht4x_identify, (1u<<0)|(1u<<4) },
+	{ SI7021, 0x41, "HTU31D", si7021_reset, si7021_identify, (1u<<0)|(1u<<4) },
+	{ SI7021, 0x40, "SI7021/HTU21D/HTU31D", si7021_reset, si7021_identify, (1u<<0)|(1u<<4)|(1u<<6)|(1u<<7) },
+};
+
+#define PROBE_CANDIDATES ((int)(sizeof(candidates)/sizeof(candidates[0])))
+
+// the DS2482 and the 1-Wire configuration need no wait, they are probed in one step
+static int ds18b20_probe(t_ds2482 *sensor, unsigned char i2c_address, long *wait_us)
+{
+	(void)wait_us;
+
+	if (!ds2482_open(sensor, i2c_address)) return 1;
+	if (!ds2482_reset(sensor)) return 2;
+	if (!OWConfigureBits(sensor)) return 3;
+	return 0;
+}
+
+const char *probe_type_name(int type)
+{
+	switch (type) {
+		case DS18B20 : return "DS18B20";
+		case AM2321 : return "AM2321";
+		case SHT4X : return "SHT4x";
+		case SHT85 : return "SHT85";
+		case HTU21D : return "HTU21D";
+		case HTU31D : return "HTU31D";
+		case SI7021 : return "SI7021";
+	}
+	return "unknown";
+}
+
+// sensor types sharing a driver
+static int probe_family(int type)
+{
+	switch (type) {
+		case SHT85 : return SHT4X;
+		case HTU21D : case HTU31D : return SI7021;
+	}
+	return type;
+}
+
+// check if a candidate is probed for the configured sensor type
+static int probe_wanted(int type, const t_probe_candidate *c)
+{
+	switch (type) {
+		case AUTO : return 1;
+		// only the HTU31D may be on 0x41
+		case SI7021 : case HTU21D : return (c->kind == SI7021) && (c->address == 0x40);
+	}
+	return c->kind == probe_family(type);
+}
+
+static void probe_init(t_probe *p, const t_probe_candidate *c, const t_ds2482 *sensor, const struct timespec *now)
+{
+	memset(p, 0, sizeof(*p));
+	p->candidate = c;
+	p->sensor = *sensor;
+	memset(&p->sensor.dev, 0, sizeof(p->sensor.dev));
+	p->sensor.serial = 0;
+	p->state = PROBE_RUNNING;
+	p->due = *now;
+	p->deadline = *now;
+	timespec_add_us(&p->deadline, PROBE_TIMEOUT_US);
+}
+
+static void probe_step(t_probe *p)
+{
+	const t_probe_candidate *c = p->candidate;
+	t_ds2482 *s = &p->sensor;
+	long wait_us = 0;
+
+	if (!p->started) {
+		p->started = 1;
+		p->result = c->reset(s, c->address, &wait_us);
+	} else
+		p->result = c->identify(s, &wait_us);
+
+	if (p->result == HUM_PENDING) {
+		clock_gettime(CLOCK_MONOTONIC, &p->due);
+		timespec_add_us(&p->due, wait_us);
+		if (timespec_before(&p->deadline, &p->due)) {
+			debug_print("Probe %s on 0x%x timed out\n", c->name, c->address);
+			p->state = PROBE_FAILED;
+		}
+		return;
+	}
+
+	if ((p->result >= 0) && (p->result < 32) && (c->accept & (1u << p->result))) {
+		// drivers which fail to read the serial number leave the type open
+		if (probe_family(s->sensor_type) != c->kind) {
+			if (c->kind == SI7021)
+				s->sensor_type = (s->hum_step == 0) ? HTU31D : SI7021;
+			else
+				s->sensor_type = c->kind;
+		}
+		p->state = PROBE_FOUND;
+	} else
+		p->state = PROBE_FAILED;
+	debug_print("Probe %s on 0x%x: %s (%d)\n", c->name, c->address, (p->state == PROBE_FOUND) ? "found" : "not found", p->result);
+}
+
+// Step all probes in order of their due time until every probe is finished.
+// The waits of one sensor are used for the I/O of the others, so the scan
+// takes as long as the slowest probe instead of the sum of all of them.
+static void probe_run(t_probe *probes, int n)
+{
+	t_probe *next;
+	int i;
+
+	for (;;) {
+		next = NULL;
+		for (i = 0; i < n; i++)
+			if ((probes[i].state == PROBE_RUNNING) && ((next == NULL) || timespec_before(&probes[i].due, &next->due)))
+				next = &probes[i];
+		if (next == NULL)
+			break;
+
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next->due, NULL) == EINTR);
+		probe_step(next);
+	}
+}
+
+// move the sensor found to its final location, the bus manager knows devices by their address
+static int probe_adopt(t_ds2482 *sensor, t_probe *p)
+{
+	*sensor = p->sensor;
+	if (i2cbus_open(&sensor->dev, p->sensor.dev.name, p->sensor.dev.bus, p->sensor.dev.address) != 0)
+		return 1;
+	i2cbus_close(&p->sensor.dev);
+	return 0;
+}
+
+static int probe_cache_read(const char *path, t_probe_cache *cache)
+{
+	char line[80];
+	FILE *fp;
+	int result = 1;
+
+	fp = fopen(path, "r");
+	if (fp == NULL)
+		return 1;
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "%d %hhx %hhu %" SCNx64, &cache->sensor_type, &cache->address, &cache->bus, &cache->serial) == 4)
+			result = 0;
+		break;
+	}
+	fclose(fp);
+	return result;
+}
+
+static void probe_cache_write(const char *path, const t_ds2482 *sensor)
+{
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	if (fp == NULL) {
+		fprintf(stderr, "Unable to write sensor cache %s: %s\n", path, strerror(errno));
+		return;
+	}
+	fprintf(fp, "# %s, format: [type] [i2c address] [i2c bus] [serial]\n", probe_type_name(sensor->sensor_type));
+	fprintf(fp, "%d 0x%02x %u 0x%016" PRIx64 "\n", sensor->sensor_type, sensor->address, sensor->dev.bus, sensor->serial);
+	fclose(fp);
+}
+
+/**
+* @brief Detect the temperature/humidity sensor
+* @param sensor pointer to sensor instance, sensor_type, bus and databits are configured
+* @param cache file with the sensor found last time, NULL if not used
+* @return 0 if a sensor was found, 1 otherwise
+*
+* A sensor found in the cache is verified alone. If it is missing, or no
+* cache is used, all candidates for the configured type are probed at the
+* same time and the result is written to the cache.
+*
+* @date 18.10.2026 born
+*
+*/
+int probe_temp_sensor(t_ds2482 *sensor, const char *cache)
+{
+	t_probe probes[PROBE_MAX];
+	t_probe_cache cached;
+	struct timespec now;
+	int i, n = 0, found = -1;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if ((cache != NULL) && (probe_cache_read(cache, &cached) == 0) && (cached.bus == sensor->bus)) {
+		for (i = 0; i < PROBE_CANDIDATES; i++)
+			if ((candidates[i].address == cached.address) && (candidates[i].kind == probe_family(cached.sensor_type)) &&
+			    probe_wanted(sensor->sensor_type, &candidates[i]))
+				break;
+
+		if (i < PROBE_CANDIDATES) {
+			probe_init(&probes[0], &candidates[i], sensor, &now);
+			probe_run(probes, 1);
+			if ((probes[0].state == PROBE_FOUND) && (probes[0].sensor.sensor_type == cached.sensor_type) &&
+			    (probes[0].sensor.serial == cached.serial) && (probe_adopt(sensor, &probes[0]) == 0)) {
+				debug_print("Cached %s on 0x%x verified\n", probe_type_name(cached.sensor_type), cached.address);
+				return 0;
+			}
+			i2cbus_close(&probes[0].sensor.dev);
+			fprintf(stderr, "Cached %s on 0x%x not found, scanning\n", probe_type_name(cached.sensor_type), cached.address);
+			clock_gettime(CLOCK_MONOTONIC, &now);
+		}
+	}
+
+	for (i = 0; (i < PROBE_CANDIDATES) && (n < PROBE_MAX); i++)
+		if (probe_wanted(sensor->sensor_type, &candidates[i]))
+			probe_init(&probes[n++], &candidates[i], sensor, &now);
+	probe_run(probes, n);
+
+	for (i = 0; i < n; i++) {
+		if ((found < 0) && (probes[i].state == PROBE_FOUND))
+			found = i;
+		else
+			i2cbus_close(&probes[i].sensor.dev);
+	}
+
+	if ((found < 0) || (probe_adopt(sensor, &probes[found]) != 0)) {
+		if (found >= 0)
+			i2cbus_close(&probes[found].sensor.dev);
+		if (cache != NULL)
+			unlink(cache);
+		return 1;
+	}
+
+	if (cache != NULL)
+		probe_cache_write(cache, sensor);
+	return 0;
+}
@@ -0,0 +1,67 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "ds2482.h"
+
+#include <time.h>
+
+// max. number of candidates probed at the same time
+#define PROBE_MAX 8
+
+// a probe which is not finished after this time in us has failed
+#define PROBE_TIMEOUT_US 200000
+
+// state of a probe
+#define PROBE_RUNNING 0
+#define PROBE_FOUND 1
+#define PROBE_FAILED 2
+
+// a sensor which may be present at an address
+typedef struct {
+	int kind;			// DS18B20, AM2321, SHT4X or SI7021
+	unsigned char address;
+	const char *name;
+	int (*reset)(t_ds2482 *, unsigned char, long *);
+	int (*identify)(t_ds2482 *, long *);
+	unsigned int accept;		// mask of driver results meaning present
+} t_probe_candidate;
+
+typedef struct {
+	const t_probe_candidate *candidate;
+	t_ds2482 sensor;		// private copy, the winner is copied back
+	int state;
+	int started;
+	int result;			// last result of the driver
+	struct timespec due;		// next step
+	struct timespec deadline;
+} t_probe;
+
+// detected topology, saved to skip the scan on the next start
+typedef struct {
+	int sensor_type;
+	unsigned char address;
+	uint8_t bus;
+	uint64_t serial;
+} t_probe_cache;
+
+int probe_temp_sensor(t_ds2482 *, const char *);
+const char *probe_type_name(int);
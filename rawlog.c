@@ -0,0 +1,243 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rawlog.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+/*
+* A raw recording is a text file. The header holds the state of the
+* pressure path after warm-up, one line per sensor:
+*
+*   # sensord raw 2
+*   static <prom0> .. <prom7> <D1> <D1f> <D2> <D2f>
+*   tep <prom0> .. <prom7> <D1> <D1f> <D2> <D2f>
+*   dynamic <digoutp> <digoutT> <offset>
+*   voltage <present> <voltage_raw>
+*   glitch <glitch> <glitchstart> <deltaxmax> <shutoff>
+*   kalman <x_abs> <x_vel> <p_abs_abs> <p_abs_vel> <p_vel_vel>
+*   filter <p_static> <p_dynamic>
+*   warm <warm start>
+*
+* The temperature filters are reset when sampling starts, unless sensord
+* resumed from a snapshot, so the warm start flag is part of the state.
+* The Kalman filter is only taken over on a warm start, otherwise the
+* replay settles it the same way as the recording did. A replay which
+* starts in the middle of a flight is a warm start.
+*
+* followed by one line per sensor tick with the raw words as read from the
+* sensors, before any compensation:
+*
+*   <seq> <sensor clock s.ns> <late> <tep adc> <static adc> <digoutp> <digoutT> <voltage_raw>
+*/
+
+static void rawlog_write_ms5611(FILE *fp, const char *name, const t_ms5611 *sensor)
+{
+	int i;
+
+	fprintf(fp, "%s", name);
+	for (i = 0; i < 8; i++)
+		fprintf(fp, " %u", sensor->prom[i]);
+	fprintf(fp, " %u %u %u %u\n", sensor->D1, sensor->D1f, sensor->D2, sensor->D2f);
+}
+
+/**
+* @brief Write the header of a raw recording
+* @param fp recording
+* @param static_sensor
+* @param tep_sensor
+* @param dynamic_sensor
+* @param voltage_sensor
+* @param state glitch detection, Kalman filter and filtered pressures
+* @return result
+*
+* Called once after warm-up, before the first tick is recorded.
+* @date 18.10.2026 born
+*
+*/
+int rawlog_write_header(FILE *fp, const t_ms5611 *static_sensor, const t_ms5611 *tep_sensor, const t_ams5915 *dynamic_sensor, const t_ads1110 *voltage_sensor, const t_rawlog_state *state)
+{
+	fprintf(fp, "%s %d\n", RAWLOG_MAGIC, RAWLOG_VERSION);
+	rawlog_write_ms5611(fp, "static", static_sensor);
+	rawlog_write_ms5611(fp, "tep", tep_sensor);
+	fprintf(fp, "dynamic %u %u %.9g\n", dynamic_sensor->digoutp, dynamic_sensor->digoutT, dynamic_sensor->offset);
+	fprintf(fp, "voltage %u %d\n", voltage_sensor->present, voltage_sensor->voltage_raw);
+	fprintf(fp, "glitch %d %d %d %d\n", state->glitch.glitch, state->glitch.glitchstart, state->glitch.deltaxmax, state->glitch.shutoff);
+	fprintf(fp, "kalman %.9g %.9g %.9g %.9g %.9g\n", state->vkf.x_abs_, state->vkf.x_vel_, state->vkf.p_abs_abs_, state->vkf.p_abs_vel_, state->vkf.p_vel_vel_);
+	fprintf(fp, "filter %.9g %.9g\n", state->p_static, state->p_dynamic);
+	fprintf(fp, "warm %d\n", state->warm_start);
+	return ferror(fp) ? 1 : 0;
+}
+
+static int rawlog_read_ms5611(FILE *fp, const char *name, t_ms5611 *sensor)
+{
+	char line[256];
+	char tag[16];
+	unsigned int p[8];
+	uint16_t prom[8];
+	uint32_t D1, D1f, D2, D2f;
+	int i;
+
+	if (fgets(line, sizeof(line), fp) == NULL)
+		return 1;
+	if ((sscanf(line, "%15s %u %u %u %u %u %u %u %u %" SCNu32 " %" SCNu32 " %" SCNu32 " %" SCNu32,
+			tag, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6], &p[7], &D1, &D1f, &D2, &D2f) != 13) || strcmp(tag, name))
+		return 1;
+
+	for (i = 0; i < 8; i++)
+		prom[i] = p[i];
+	ms5611_load_prom(sensor, prom);
+	sensor->D1 = sensor->D1l = D1;
+	sensor->D1f = D1f;
+	sensor->D2 = D2;
+	ms5611_resume_temp(sensor, D2, D2f);
+	return 0;
+}
+
+/**
+* @brief Read the header of a raw recording and restore the sensor state
+* @param fp recording
+* @param static_sensor
+* @param tep_sensor
+* @param dynamic_sensor
+* @param voltage_sensor
+* @param state receives glitch detection, Kalman filter and filtered pressures
+* @return 0 for a raw recording, 1 for the pressure format, -1 on errors
+*
+* A file without the raw header is rewound, it holds compensated pressures.
+* @date 18.10.2026 born
+*
+*/
+int rawlog_read_header(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tep_sensor, t_ams5915 *dynamic_sensor, t_ads1110 *voltage_sensor, t_rawlog_state *state)
+{
+	char line[256];
+	unsigned int digoutp, digoutT, present;
+	int version;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) || strncmp(line, RAWLOG_MAGIC, strlen(RAWLOG_MAGIC))) {
+		rewind(fp);
+		return 1;
+	}
+
+	if ((sscanf(line + strlen(RAWLOG_MAGIC), "%d", &version) != 1) || (version != RAWLOG_VERSION)) {
+		fprintf(stderr, "Unsupported raw recording version\n");
+		return -1;
+	}
+
+	if (rawlog_read_ms5611(fp, "static", static_sensor) || rawlog_read_ms5611(fp, "tep", tep_sensor))
+		goto broken;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "dynamic %u %u %f", &digoutp, &digoutT, &dynamic_sensor->offset) != 3))
+		goto broken;
+	dynamic_sensor->digoutp = digoutp;
+	dynamic_sensor->digoutT = digoutT;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "voltage %u %d", &present, &voltage_sensor->voltage_raw) != 2))
+		goto broken;
+	voltage_sensor->present = present;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "glitch %d %d %d %d", &state->glitch.glitch, &state->glitch.glitchstart, &state->glitch.deltaxmax, &state->glitch.shutoff) != 4))
+		goto broken;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "kalman %f %f %f %f %f", &state->vkf.x_abs_, &state->vkf.x_vel_, &state->vkf.p_abs_abs_, &state->vkf.p_abs_vel_, &state->vkf.p_vel_vel_) != 5))
+		goto broken;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "filter %f %f", &state->p_static, &state->p_dynamic) != 2))
+		goto broken;
+
+	if ((fgets(line, sizeof(line), fp) == NULL) ||
+		(sscanf(line, "warm %d", &state->warm_start) != 1))
+		goto broken;
+	return 0;
+
+broken:
+	fprintf(stderr, "Broken raw recording header\n");
+	return -1;
+}
+
+/**
+* @brief Record the raw words of a sample
+* @param fp recording
+* @param sample
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int rawlog_write(FILE *fp, const t_sample *sample)
+{
+	fprintf(fp, "%lu %ld.%09ld %.9g %u %u %u %u %d\n", sample->seq,
+		(long)sample->t_sensor.tv_sec, sample->t_sensor.tv_nsec, sample->late,
+		sample->tep_adc, sample->static_adc, sample->digoutp, sample->digoutT, sample->voltage_raw);
+	return ferror(fp) ? 1 : 0;
+}
+
+/**
+* @brief Record the pressures of a sample in the data log format of -r
+* @param fp data log
+* @param sample
+* @param extended add the D1/D2 values and the glitch counter (-j)
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int rawlog_write_pressure(FILE *fp, const t_sample *sample, int extended)
+{
+	if (extended)
+		fprintf(fp, "%.4f %.4f %f %u %u %u %u %u %u %u %u %d\n",sample->p_tep,sample->p_static_raw,sample->p_dynamic_raw,sample->static_D1,sample->static_D1f,sample->tep_D1,sample->tep_D1f,sample->static_D2,sample->static_D2f,sample->tep_D2,sample->tep_D2f,sample->glitch);
+	else fprintf(fp, "%.4f,%.4f,%.4f\n",sample->p_tep,sample->p_static_raw,sample->p_dynamic_raw);
+	return ferror(fp) ? 1 : 0;
+}
+
+/**
+* @brief Read the raw words of the next tick
+* @param fp recording
+* @param sample receives seq, t_sensor, late and the raw words
+* @return 0 on success, 1 at the end of the recording
+*
+* @date 18.10.2026 born
+*
+*/
+int rawlog_read(FILE *fp, t_sample *sample)
+{
+	char line[256];
+	long sec, nsec;
+	unsigned int digoutp, digoutT;
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (sscanf(line, "%lu %ld.%ld %f %" SCNu32 " %" SCNu32 " %u %u %d", &sample->seq, &sec, &nsec, &sample->late,
+				&sample->tep_adc, &sample->static_adc, &digoutp, &digoutT, &sample->voltage_raw) != 9) {
+			fprintf(stderr, "Skipping broken raw record: %s", line);
+			continue;
+		}
+		sample->t_sensor.tv_sec = sec;
+		sample->t_sensor.tv_nsec = nsec;
+		sample->digoutp = digoutp;
+		sample->digoutT = digoutT;
+		return 0;
+	}
+	return 1;
+}
@@ -0,0 +1,48 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ms5611.h"
+#include "ams5915.h"
+#include "ads1110.h"
+#include "ring.h"
+#include "main.h"
+#include "KalmanFilter1d.h"
+
+#include <stdio.h>
+
+// first line of a raw recording
+#define RAWLOG_MAGIC "# sensord raw"
+#define RAWLOG_VERSION 2
+
+// state of the pressure path besides the sensors
+typedef struct {
+	t_glitch glitch;
+	t_kalmanfilter1d vkf;
+	float p_static;			// filtered pressures
+	float p_dynamic;
+	int warm_start;			// resumed from a snapshot
+} t_rawlog_state;
+
+int rawlog_write_header(FILE *, const t_ms5611 *, const t_ms5611 *, const t_ams5915 *, const t_ads1110 *, const t_rawlog_state *);
+int rawlog_read_header(FILE *, t_ms5611 *, t_ms5611 *, t_ams5915 *, t_ads1110 *, t_rawlog_state *);
+int rawlog_write(FILE *, const t_sample *);
+int rawlog_write_pressure(FILE *, const t_sample *, int);
+int rawlog_read(FILE *, t_sample *);
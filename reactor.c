@@ -0,0 +1,361 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "reactor.h"
+#include "clock.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+// epoll data carries the slot index and the generation of its source
+#define REACTOR_SLOT(data) ((uint32_t)((data) & 0xffffffff))
+#define REACTOR_GEN(data) ((uint32_t)((data) >> 32))
+
+static uint64_t reactor_data(t_reactor *r, int i)
+{
+	return ((uint64_t)r->sources[i].gen << 32) | (uint32_t)i;
+}
+
+/**
+* @brief Create the epoll instance of a reactor
+* @param r pointer to reactor instance
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_open(t_reactor *r)
+{
+	int i;
+
+	r->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (r->epfd < 0) {
+		fprintf(stderr, "epoll_create1 failed: %s\n", strerror(errno));
+		return 1;
+	}
+
+	for (i = 0; i < REACTOR_MAX_SOURCES; i++) {
+		r->sources[i].fd = -1;
+		r->sources[i].gen = 0;
+	}
+	r->running = 0;
+	return 0;
+}
+
+void reactor_close(t_reactor *r)
+{
+	int i;
+
+	for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+		if ((r->sources[i].fd >= 0) && (r->sources[i].timer != NULL))
+			close(r->sources[i].fd);
+	close(r->epfd);
+}
+
+static int reactor_register(t_reactor *r, int fd, uint32_t events, int prio, t_reactor_timer *timer, t_reactor_handler handler, void *ctx)
+{
+	struct epoll_event ev;
+	int i;
+
+	for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+		if (r->sources[i].fd < 0) break;
+
+	if (i == REACTOR_MAX_SOURCES) {
+		fprintf(stderr, "reactor: too many event sources\n");
+		return 1;
+	}
+
+	// events of a removed source which are still queued in the current
+	// batch must not reach the new owner of the slot
+	r->sources[i].gen++;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.u64 = reactor_data(r, i);
+	if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		fprintf(stderr, "epoll_ctl add failed: %s\n", strerror(errno));
+		return 1;
+	}
+
+	r->sources[i].fd = fd;
+	r->sources[i].prio = prio;
+	r->sources[i].timer = timer;
+	r->sources[i].handler = handler;
+	r->sources[i].ctx = ctx;
+	return 0;
+}
+
+static int reactor_find(t_reactor *r, int fd)
+{
+	int i;
+
+	for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+		if (r->sources[i].fd == fd) return i;
+	return -1;
+}
+
+/**
+* @brief Watch a file descriptor
+* @param r pointer to reactor instance
+* @param fd file descriptor
+* @param events epoll event mask
+* @param prio dispatch priority, lower values are handled first
+* @param handler callback
+* @param ctx callback context
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_add_fd(t_reactor *r, int fd, uint32_t events, int prio, t_reactor_handler handler, void *ctx)
+{
+	return reactor_register(r, fd, events, prio, NULL, handler, ctx);
+}
+
+int reactor_modify_fd(t_reactor *r, int fd, uint32_t events)
+{
+	struct epoll_event ev;
+	int i = reactor_find(r, fd);
+
+	if (i < 0) return 1;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.u64 = reactor_data(r, i);
+	if (epoll_ctl(r->epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+		fprintf(stderr, "epoll_ctl mod failed: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+int reactor_remove_fd(t_reactor *r, int fd)
+{
+	int i = reactor_find(r, fd);
+
+	if (i < 0) return 1;
+
+	epoll_ctl(r->epfd, EPOLL_CTL_DEL, fd, NULL);
+	r->sources[i].fd = -1;
+	return 0;
+}
+
+/**
+* @brief Add a periodic timer
+* @param r pointer to reactor instance
+* @param timer pointer to timer instance
+* @param period_us timer period in us, 0 for a free running source
+* @param phase_us offset of the first expiry in us
+* @param prio dispatch priority, lower values are handled first
+* @param handler callback
+* @param ctx callback context
+* @return result
+*
+* A free running timer is serviced on every pass of the event loop. It is
+* used for replay where data is processed as fast as possible.
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_add_timer(t_reactor *r, t_reactor_timer *timer, long period_us, long phase_us, int prio, t_reactor_handler handler, void *ctx)
+{
+	struct itimerspec its;
+
+	memset(timer, 0, sizeof(*timer));
+	timer->period_ns = (int64_t)period_us * 1000;
+	clock_gettime(CLOCK_MONOTONIC, &timer->deadline);
+
+	if (period_us == 0) {
+		// an eventfd which is never read stays readable
+		timer->fd = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (timer->fd < 0) {
+			fprintf(stderr, "eventfd failed: %s\n", strerror(errno));
+			return 1;
+		}
+	} else {
+		timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (timer->fd < 0) {
+			fprintf(stderr, "timerfd_create failed: %s\n", strerror(errno));
+			return 1;
+		}
+
+		timespec_add_us(&timer->deadline, period_us + phase_us);
+		its.it_value = timer->deadline;
+		its.it_interval.tv_sec = period_us / 1000000;
+		its.it_interval.tv_nsec = (period_us % 1000000) * 1000;
+		if (timerfd_settime(timer->fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+			fprintf(stderr, "timerfd_settime failed: %s\n", strerror(errno));
+			close(timer->fd);
+			return 1;
+		}
+	}
+
+	if (reactor_register(r, timer->fd, EPOLLIN, prio, timer, handler, ctx)) {
+		close(timer->fd);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Add a one-shot timer, it fires once per reactor_arm_timer() call
+* @param r pointer to reactor instance
+* @param timer pointer to timer instance
+* @param prio dispatch priority, lower values are handled first
+* @param handler callback
+* @param ctx callback context
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_add_oneshot(t_reactor *r, t_reactor_timer *timer, int prio, t_reactor_handler handler, void *ctx)
+{
+	memset(timer, 0, sizeof(*timer));
+	timer->oneshot = 1;
+
+	timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (timer->fd < 0) {
+		fprintf(stderr, "timerfd_create failed: %s\n", strerror(errno));
+		return 1;
+	}
+
+	if (reactor_register(r, timer->fd, EPOLLIN, prio, timer, handler, ctx)) {
+		close(timer->fd);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Arm a one-shot timer, replaces a pending expiry
+* @param timer pointer to timer instance
+* @param delay_us delay from now in us
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_arm_timer(t_reactor_timer *timer, long delay_us)
+{
+	struct itimerspec its;
+
+	clock_gettime(CLOCK_MONOTONIC, &timer->deadline);
+	timespec_add_us(&timer->deadline, delay_us);
+
+	memset(&its, 0, sizeof(its));
+	its.it_value = timer->deadline;
+	if (timerfd_settime(timer->fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+		fprintf(stderr, "timerfd_settime failed: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+// Consume the expirations of a timer and record how late it is serviced.
+// Lateness is measured against the oldest expiry not yet serviced.
+static int reactor_timer_expired(t_reactor_timer *timer)
+{
+	uint64_t expirations;
+	struct timespec now;
+	int64_t ns;
+
+	// free running source, a one-shot timer has no period either
+	if ((timer->period_ns == 0) && !timer->oneshot) {
+		timer->late = 0;
+		timer->ticks++;
+		return 1;
+	}
+
+	if (read(timer->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+		return 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	timer->late = timespec_delta_us(&now, &timer->deadline);
+	if (timer->late > timer->late_max) timer->late_max = timer->late;
+	timer->late_sum += timer->late;
+	timer->ticks++;
+	if (timer->oneshot) return 1;
+	timer->missed += expirations - 1;
+
+	ns = timer->deadline.tv_nsec + expirations * timer->period_ns;
+	timer->deadline.tv_sec += ns / 1000000000;
+	timer->deadline.tv_nsec = ns % 1000000000;
+	return 1;
+}
+
+/**
+* @brief Run the event loop until reactor_stop() is called
+* @param r pointer to reactor instance
+* @return result
+*
+* Events which are ready at the same time are dispatched in order of their
+* priority, so the sensor tick is never serviced after output I/O.
+*
+* @date 18.10.2026 born
+*
+*/
+int reactor_run(t_reactor *r)
+{
+	struct epoll_event events[REACTOR_MAX_SOURCES];
+	int n, i, j;
+
+	r->running = 1;
+	while (r->running)
+	{
+		n = epoll_wait(r->epfd, events, REACTOR_MAX_SOURCES, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			fprintf(stderr, "epoll_wait failed: %s\n", strerror(errno));
+			return 1;
+		}
+
+		// sort ready events by priority
+		for (i = 1; i < n; i++) {
+			struct epoll_event ev = events[i];
+			for (j = i; (j > 0) && (r->sources[REACTOR_SLOT(events[j-1].data.u64)].prio > r->sources[REACTOR_SLOT(ev.data.u64)].prio); j--)
+				events[j] = events[j-1];
+			events[j] = ev;
+		}
+
+		for (i = 0; (i < n) && r->running; i++) {
+			t_reactor_source *src = &r->sources[REACTOR_SLOT(events[i].data.u64)];
+
+			// source may have been removed or replaced by an earlier handler
+			if ((src->fd < 0) || (src->gen != REACTOR_GEN(events[i].data.u64)))
+				continue;
+
+			if ((src->timer != NULL) && !reactor_timer_expired(src->timer))
+				continue;
+			src->handler(src->ctx, events[i].events);
+		}
+	}
+	return 0;
+}
+
+void reactor_stop(t_reactor *r)
+{
+	r->running = 0;
+}
@@ -0,0 +1,72 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/epoll.h>
+
+#define REACTOR_MAX_SOURCES 32
+
+// priorities, lower values are dispatched first
+#define REACTOR_PRIO_SENSOR 0
+#define REACTOR_PRIO_TEMP 1
+#define REACTOR_PRIO_OUTPUT 2
+
+typedef void (*t_reactor_handler)(void *ctx, uint32_t events);
+
+// periodic timer based on a timerfd
+typedef struct {
+	int fd;
+	int64_t period_ns;
+	int oneshot;			// armed by reactor_arm_timer()
+	struct timespec deadline;	// next expected expiry
+	float late;			// lateness of the last serviced tick in us
+	float late_max;
+	double late_sum;
+	unsigned long ticks;
+	unsigned long missed;
+} t_reactor_timer;
+
+typedef struct {
+	int fd;
+	int prio;
+	uint32_t gen;			// bumped on reuse, stale events are dropped
+	t_reactor_timer *timer;
+	t_reactor_handler handler;
+	void *ctx;
+} t_reactor_source;
+
+typedef struct {
+	int epfd;
+	int running;
+	t_reactor_source sources[REACTOR_MAX_SOURCES];
+} t_reactor;
+
+int reactor_open(t_reactor *);
+void reactor_close(t_reactor *);
+int reactor_add_fd(t_reactor *, int, uint32_t, int, t_reactor_handler, void *);
+int reactor_modify_fd(t_reactor *, int, uint32_t);
+int reactor_remove_fd(t_reactor *, int);
+int reactor_add_timer(t_reactor *, t_reactor_timer *, long, long, int, t_reactor_handler, void *);
+int reactor_add_oneshot(t_reactor *, t_reactor_timer *, int, t_reactor_handler, void *);
+int reactor_arm_timer(t_reactor_timer *, long);
+int reactor_run(t_reactor *);
+void reactor_stop(t_reactor *);
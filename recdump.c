@@ -0,0 +1,232 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "recorder.h"
+#include "rawlog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// recdump - convert a binary recording (sensord -b) into the text formats
+
+enum { FORMAT_PRESSURE, FORMAT_EXTENDED, FORMAT_RAW };
+
+/**
+* @brief Write the raw log header for a replay starting at the current block
+* @param f reader positioned at the block
+* @return result
+*
+* The sensors are taken from the state at the start of the recording, the
+* pressure path from the keyframe of the block.
+*
+* @date 18.10.2026 born
+*
+*/
+static int write_state(const t_recorder_file *f)
+{
+	const t_recorder_keyframe *k = &f->keyframe;
+	t_ms5611 static_sensor, tep_sensor;
+	t_ams5915 dynamic_sensor;
+	t_ads1110 voltage_sensor;
+	t_rawlog_state state;
+	FILE *fp;
+	int result;
+
+	if (!k->valid) {
+		fwrite(f->header.state, 1, f->header.state_len, stdout);
+		return 0;
+	}
+
+	memset(&static_sensor, 0, sizeof(static_sensor));
+	memset(&tep_sensor, 0, sizeof(tep_sensor));
+	memset(&dynamic_sensor, 0, sizeof(dynamic_sensor));
+	memset(&voltage_sensor, 0, sizeof(voltage_sensor));
+	memset(&state, 0, sizeof(state));
+
+	fp = fmemopen((void *)f->header.state, f->header.state_len, "r");
+	if (fp == NULL)
+		return 1;
+	result = rawlog_read_header(fp, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, &state);
+	fclose(fp);
+	if (result != 0)
+		return 1;
+
+	static_sensor.D1 = static_sensor.D1l = k->static_D1;
+	static_sensor.D1f = k->static_D1f;
+	static_sensor.D2 = k->static_D2;
+	ms5611_resume_temp(&static_sensor, k->static_D2, k->static_D2f);
+	tep_sensor.D1 = tep_sensor.D1l = k->tep_D1;
+	tep_sensor.D1f = k->tep_D1f;
+	tep_sensor.D2 = k->tep_D2;
+	ms5611_resume_temp(&tep_sensor, k->tep_D2, k->tep_D2f);
+
+	state.glitch.glitch = k->glitch;
+	state.glitch.glitchstart = k->glitchstart;
+	state.glitch.deltaxmax = k->deltaxmax;
+	state.glitch.shutoff = k->shutoff;
+	state.vkf.x_abs_ = k->x_abs;
+	state.vkf.x_vel_ = k->x_vel;
+	state.vkf.p_abs_abs_ = k->p_abs_abs;
+	state.vkf.p_abs_vel_ = k->p_abs_vel;
+	state.vkf.p_vel_vel_ = k->p_vel_vel;
+	state.p_static = k->p_static;
+	state.p_dynamic = k->p_dynamic;
+	// the temperature filter runs on from the keyframe
+	state.warm_start = 1;
+
+	return rawlog_write_header(stdout, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, &state);
+}
+
+// last block of a file starting at or before time, 0 if there is none
+static uint32_t find_block(const t_recorder_file *f, int64_t time)
+{
+	uint32_t n = 0;
+
+	while ((n + 1 < f->blocks) && (f->index[n + 1].time <= time))
+		n++;
+	return n;
+}
+
+int main (int argc, char **argv) {
+
+	// local variables
+	t_recorder_file f;
+	t_recorder_record rec;
+	t_sample sample;
+	t_recorder_file next;
+	int format = FORMAT_PRESSURE;
+	int header = 0;
+	int started = 0;
+	int have_start = 0;
+	int c, i;
+	unsigned long records;
+	double start = 0;
+	int64_t start_time = 0;
+
+	// usage message
+	const char* Usage = "\n"\
+	"  -j              pressures with D1/D2 and glitch counter, as sensord -j -r\n"\
+	"  -w              raw sensor words, as sensord -w, for replay with sensord -p\n"\
+	"  default         pressures, as sensord -r\n"\
+	"  -s seconds      start at the block containing this time into the recording\n"\
+	"\n"\
+	"  A delta recording (record_format delta) only holds the raw sensor words and\n"\
+	"  is converted with -w, the pressures are computed by replay with sensord -p.\n"\
+	"\n"\
+	"  The files of a rotated recording are given in order: recdump flight.000 flight.001 ...\n"\
+	"\n";
+
+	while ((c = getopt (argc, argv, "hjws:")) != -1)
+	{
+		switch (c) {
+			case 'j':
+				format = FORMAT_EXTENDED;
+				break;
+
+			case 'w':
+				format = FORMAT_RAW;
+				break;
+
+			case 's':
+				start = atof(optarg);
+				break;
+
+			default:
+				fprintf(stderr, "Usage: recdump [OPTION] FILE...\n%s", Usage);
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "Usage: recdump [OPTION] FILE...\n%s", Usage);
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = optind; i < argc; i++) {
+		if (recorder_file_open(&f, argv[i]) != 0)
+			exit(EXIT_FAILURE);
+
+		if ((f.header.format == RECORDER_DELTA) && (format != FORMAT_RAW)) {
+			fprintf(stderr, "%s is a delta recording without pressures, convert it with -w and replay with sensord -p\n", argv[i]);
+			exit(EXIT_FAILURE);
+		}
+
+		if ((format == FORMAT_RAW) && (f.header.state_len == 0)) {
+			fprintf(stderr, "%s has no raw sensor state, recorded from a pressure replay\n", argv[i]);
+			exit(EXIT_FAILURE);
+		}
+
+		if (f.blocks == 0) {
+			recorder_file_close(&f);
+			continue;
+		}
+
+		// skip to the block containing the start time, a whole file is
+		// skipped if the next one starts early enough
+		if (!started) {
+			if (!have_start) {
+				start_time = f.index[0].time + (int64_t)(start * 1e9);
+				have_start = 1;
+			}
+
+			if ((i + 1 < argc) && (f.index[f.blocks - 1].time < start_time) &&
+				(recorder_file_open(&next, argv[i + 1]) == 0)) {
+				int skip = (next.blocks > 0) && (next.index[0].time <= start_time);
+
+				recorder_file_close(&next);
+				if (skip) {
+					recorder_file_close(&f);
+					continue;
+				}
+			}
+
+			if (recorder_file_seek(&f, find_block(&f, start_time)) != 0) {
+				recorder_file_close(&f);
+				continue;
+			}
+			started = 1;
+		}
+
+		// the raw log header is the state in front of the first record
+		if ((format == FORMAT_RAW) && !header) {
+			if (write_state(&f) != 0) {
+				fprintf(stderr, "%s: broken raw sensor state\n", argv[i]);
+				exit(EXIT_FAILURE);
+			}
+			header = 1;
+		}
+
+		records = 0;
+		while (recorder_file_read(&f, &rec) == 0) {
+			recorder_unpack(&rec, &sample);
+			records++;
+			if (format == FORMAT_RAW)
+				rawlog_write(stdout, &sample);
+			else if (sample.record)
+				rawlog_write_pressure(stdout, &sample, format == FORMAT_EXTENDED);
+		}
+
+		if (!f.complete)
+			fprintf(stderr, "%s was not closed cleanly, %lu records recovered\n", argv[i], records);
+		recorder_file_close(&f);
+	}
+	return 0;
+}
@@ -0,0 +1,867 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "recorder.h"
+#include "crc32.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+/*
+* A recording is a series of files <path>.000, <path>.001, ... of about
+* the configured size. Every file starts with a header of RECORDER_ALIGN
+* bytes, followed by blocks aligned to RECORDER_BLOCK_ALIGN. A block holds
+* a block header, a keyframe and records up to RECORDER_BLOCK_SIZE bytes,
+* either as t_recorder_record or delta coded.
+*
+* The keyframe carries the state of the pressure path before the first
+* record, so a raw replay can start at any block. In the delta format a
+* block is closed after RECORDER_KEYFRAME_INTERVAL records.
+*
+* The last block is written again every RECORDER_FLUSH_INTERVAL seconds
+* while it fills up. After a crash at most that much is lost, and a torn
+* block is detected by its CRC. A file which was closed cleanly ends with
+* an index of its blocks and a trailer.
+*/
+
+#define ALIGN_UP(n) (((n) + RECORDER_BLOCK_ALIGN - 1) & ~(size_t)(RECORDER_BLOCK_ALIGN - 1))
+
+static void recorder_report(t_recorder *r, const char *what)
+{
+	// only the first of a series of failures is reported
+	if (r->errors++ == 0)
+		fprintf(stderr, "Recorder: %s %s.%03u failed: %s\n", what, r->path, r->header.segment, strerror(errno));
+}
+
+static inline uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+	while (v >= 0x80) {
+		*p++ = v | 0x80;
+		v >>= 7;
+	}
+	*p++ = v;
+	return p;
+}
+
+static inline const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	while ((p < end) && (shift < 64)) {
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80))
+			return p;
+		shift += 7;
+	}
+	return NULL;
+}
+
+static inline uint64_t zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// lateness in ns, the float holds a few bits less than that
+static inline int64_t late_ns(float late)
+{
+	if (!(fabsf(late) < 1e9f))
+		return 0;
+	return llround((double)late * 1000);
+}
+
+static inline uint32_t float_bits(float f)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+// The lateness is coded as the change in ns to the previous one and the
+// distance in float steps from the value of the whole ns. Values which
+// do not fit keep their bits.
+static inline uint64_t late_code(float late, float prev)
+{
+	int64_t ns, adj;
+
+	if (fabsf(late) < 1e9f) {
+		ns = late_ns(late);
+		adj = (int64_t)float_bits(late) - float_bits((float)(ns / 1000.0));
+		if ((adj >= -4) && (adj < 4))
+			return (zigzag(ns - late_ns(prev)) << 4) | ((adj + 4) << 1);
+	}
+	return ((uint64_t)float_bits(late) << 1) | 1;
+}
+
+static inline float late_value(uint64_t code, float prev)
+{
+	uint32_t bits = code >> 1;
+	float late;
+
+	if (!(code & 1)) {
+		int64_t ns = late_ns(prev) + unzigzag(code >> 4);
+
+		bits = float_bits((float)(ns / 1000.0)) + ((code >> 1) & 7) - 4;
+	}
+	memcpy(&late, &bits, sizeof(late));
+	return late;
+}
+
+// mask bits of a delta coded record, a field is only stored if its bit is set
+#define DELTA_SEQ	0x01	// seq does not follow the previous one
+#define DELTA_TIME	0x02	// time step without lateness differs from the previous one
+#define DELTA_LATE	0x04
+#define DELTA_TEP	0x08	// differs from the word two ticks back
+#define DELTA_STATIC	0x10
+#define DELTA_DIGOUTP	0x20
+#define DELTA_DIGOUTT	0x40
+#define DELTA_VOLTAGE	0x80
+
+/**
+* @brief Delta code the raw words of a record
+* @param d coder state
+* @param buf at least RECORDER_MAX_DELTA bytes
+* @param rec
+* @return number of bytes written
+*
+* The MS5611 words alternate between pressure and temperature, so they are
+* predicted from the record before the previous one. Most of the jitter of
+* the time step is the lateness of the tick, the time is coded as the change
+* of the step with the change of lateness taken out. Every field takes a
+* constant number of operations.
+*
+* @date 18.10.2026 born
+*
+*/
+size_t recorder_encode(t_recorder_delta *d, uint8_t *buf, const t_recorder_record *rec)
+{
+	const t_recorder_record *prev = &d->prev;
+	uint8_t *p = buf + 1;
+	uint8_t mask = 0;
+	int64_t dt = rec->time - prev->time - (late_ns(rec->late) - late_ns(prev->late));
+
+	if (rec->seq != prev->seq + 1) {
+		mask |= DELTA_SEQ;
+		p = put_varint(p, zigzag((int64_t)rec->seq - prev->seq - 1));
+	}
+	if (dt != d->dt) {
+		mask |= DELTA_TIME;
+		p = put_varint(p, zigzag(dt - d->dt));
+	}
+	if (float_bits(rec->late) != float_bits(prev->late)) {
+		mask |= DELTA_LATE;
+		p = put_varint(p, late_code(rec->late, prev->late));
+	}
+	if (rec->tep_adc != d->tep_adc) {
+		mask |= DELTA_TEP;
+		p = put_varint(p, zigzag((int64_t)rec->tep_adc - d->tep_adc));
+	}
+	if (rec->static_adc != d->static_adc) {
+		mask |= DELTA_STATIC;
+		p = put_varint(p, zigzag((int64_t)rec->static_adc - d->static_adc));
+	}
+	if (rec->digoutp != prev->digoutp) {
+		mask |= DELTA_DIGOUTP;
+		p = put_varint(p, zigzag((int32_t)rec->digoutp - prev->digoutp));
+	}
+	if (rec->digoutT != prev->digoutT) {
+		mask |= DELTA_DIGOUTT;
+		p = put_varint(p, zigzag((int32_t)rec->digoutT - prev->digoutT));
+	}
+	if (rec->voltage_raw != prev->voltage_raw) {
+		mask |= DELTA_VOLTAGE;
+		p = put_varint(p, zigzag((int64_t)rec->voltage_raw - prev->voltage_raw));
+	}
+	buf[0] = mask;
+
+	d->tep_adc = prev->tep_adc;
+	d->static_adc = prev->static_adc;
+	d->dt = dt;
+	d->prev = *rec;
+	return p - buf;
+}
+
+/**
+* @brief Decode a record written by recorder_encode()
+* @param d coder state
+* @param buf
+* @param len bytes available
+* @param rec receives the raw words, everything else is cleared
+* @return number of bytes used, 0 if the data is broken
+*
+* @date 18.10.2026 born
+*
+*/
+size_t recorder_decode(t_recorder_delta *d, const uint8_t *buf, size_t len, t_recorder_record *rec)
+{
+	const t_recorder_record *prev = &d->prev;
+	const uint8_t *p = buf + 1;
+	const uint8_t *end = buf + len;
+	uint64_t v;
+	uint8_t mask;
+	int64_t dt = d->dt;
+
+	if (len == 0)
+		return 0;
+	mask = buf[0];
+	memset(rec, 0, sizeof(*rec));
+	rec->seq = prev->seq + 1;
+	rec->late = prev->late;
+	rec->tep_adc = d->tep_adc;
+	rec->static_adc = d->static_adc;
+	rec->digoutp = prev->digoutp;
+	rec->digoutT = prev->digoutT;
+	rec->voltage_raw = prev->voltage_raw;
+
+#define FIELD(bit, expr) \
+	if (mask & (bit)) { \
+		if ((p = get_varint(p, end, &v)) == NULL) return 0; \
+		expr; \
+	}
+	FIELD(DELTA_SEQ, rec->seq += unzigzag(v))
+	FIELD(DELTA_TIME, dt += unzigzag(v))
+	FIELD(DELTA_LATE, rec->late = late_value(v, prev->late))
+	FIELD(DELTA_TEP, rec->tep_adc += unzigzag(v))
+	FIELD(DELTA_STATIC, rec->static_adc += unzigzag(v))
+	FIELD(DELTA_DIGOUTP, rec->digoutp += unzigzag(v))
+	FIELD(DELTA_DIGOUTT, rec->digoutT += unzigzag(v))
+	FIELD(DELTA_VOLTAGE, rec->voltage_raw += unzigzag(v))
+#undef FIELD
+	rec->time = prev->time + dt + (late_ns(rec->late) - late_ns(prev->late));
+
+	d->tep_adc = prev->tep_adc;
+	d->static_adc = prev->static_adc;
+	d->dt = dt;
+	d->prev = *rec;
+	return p - buf;
+}
+
+// the pressure path after a record
+static void recorder_keyframe(t_recorder_keyframe *k, const t_recorder_record *rec)
+{
+	k->valid = 1;
+	k->static_D1 = rec->static_D1;
+	k->static_D1f = rec->static_D1f;
+	k->static_D2 = rec->static_D2;
+	k->static_D2f = rec->static_D2f;
+	k->tep_D1 = rec->tep_D1;
+	k->tep_D1f = rec->tep_D1f;
+	k->tep_D2 = rec->tep_D2;
+	k->tep_D2f = rec->tep_D2f;
+	k->glitch = rec->glitch;
+	k->glitchstart = rec->glitchstart;
+	k->deltaxmax = rec->deltaxmax;
+	k->shutoff = rec->shutoff;
+	k->x_abs = rec->x_abs;
+	k->x_vel = rec->x_vel;
+	k->p_abs_abs = rec->p_abs_abs;
+	k->p_abs_vel = rec->p_abs_vel;
+	k->p_vel_vel = rec->p_vel_vel;
+	k->p_static = rec->p_static;
+	k->p_dynamic = rec->p_dynamic;
+}
+
+// start a block with the keyframe of the last record
+static void recorder_new_block(t_recorder *r)
+{
+	t_recorder_block *b = (t_recorder_block *)r->block;
+
+	memset(r->block, 0, RECORDER_BLOCK_SIZE);
+	b->magic = RECORDER_BLOCK_MAGIC;
+	if (r->have_last)
+		recorder_keyframe((t_recorder_keyframe *)(r->block + sizeof(t_recorder_block)), &r->last);
+	r->block_len = sizeof(t_recorder_block) + sizeof(t_recorder_keyframe);
+	memset(&r->delta, 0, sizeof(r->delta));
+}
+
+// start the next file of the recording
+static int recorder_file_start(t_recorder *r)
+{
+	char name[80];
+
+	snprintf(name, sizeof(name), "%s.%03u", r->path, r->header.segment);
+	r->fd = open(name, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+	if (r->fd < 0) {
+		recorder_report(r, "open");
+		return 1;
+	}
+
+	r->header.crc = 0;
+	r->header.crc = crc32_ieee(&r->header, sizeof(r->header));
+	if (pwrite(r->fd, &r->header, sizeof(r->header), 0) != sizeof(r->header))
+		recorder_report(r, "write header of");
+
+	r->block_offset = RECORDER_ALIGN;
+	r->blocks = 0;
+	r->records = 0;
+	recorder_new_block(r);
+	return 0;
+}
+
+// write the current block, returns the size on disk
+static size_t recorder_write_block(t_recorder *r)
+{
+	t_recorder_block *b = (t_recorder_block *)r->block;
+	size_t len = ALIGN_UP(r->block_len);
+
+	b->size = r->block_len - sizeof(t_recorder_block);
+	b->crc = crc32_ieee(r->block + sizeof(t_recorder_block), b->size);
+	if ((r->fd >= 0) && (pwrite(r->fd, r->block, len, r->block_offset) != (ssize_t)len))
+		recorder_report(r, "write");
+	return len;
+}
+
+// write the current block for good and add it to the index
+static void recorder_end_block(t_recorder *r)
+{
+	t_recorder_block *b = (t_recorder_block *)r->block;
+	t_recorder_index *index;
+
+	if (r->blocks == r->index_size) {
+		index = realloc(r->index, (r->index_size + 256) * sizeof(*index));
+		if (index != NULL) {
+			r->index = index;
+			r->index_size += 256;
+		}
+	}
+	if (r->blocks < r->index_size) {
+		r->index[r->blocks].first_seq = b->first_seq;
+		r->index[r->blocks].count = b->count;
+		r->index[r->blocks].time = b->time;
+		r->index[r->blocks].offset = r->block_offset;
+	}
+
+	r->block_offset += recorder_write_block(r);
+	r->blocks++;
+	recorder_new_block(r);
+}
+
+// close the current file with index and trailer
+static void recorder_file_finish(t_recorder *r)
+{
+	t_recorder_trailer t;
+	size_t len;
+
+	if (r->fd < 0)
+		return;
+
+	if (((t_recorder_block *)r->block)->count)
+		recorder_end_block(r);
+
+	memset(&t, 0, sizeof(t));
+	t.magic = RECORDER_TRAILER_MAGIC;
+	t.blocks = (r->blocks <= r->index_size) ? r->blocks : 0;
+	t.records = r->records;
+	t.first_seq = r->first_seq;
+	t.last_seq = r->last_seq;
+	len = t.blocks * sizeof(t_recorder_index);
+	t.index_crc = crc32_ieee(r->index, len);
+	t.crc = crc32_ieee(&t, offsetof(t_recorder_trailer, crc));
+	if ((len && (pwrite(r->fd, r->index, len, r->block_offset) != (ssize_t)len)) ||
+		(pwrite(r->fd, &t, sizeof(t), r->block_offset + len) != sizeof(t)))
+		recorder_report(r, "write trailer of");
+
+	fdatasync(r->fd);
+	close(r->fd);
+	r->fd = -1;
+}
+
+// add a record to the current block, the block is closed when it is full
+static void recorder_add(t_recorder *r, const t_recorder_record *rec)
+{
+	t_recorder_block *b = (t_recorder_block *)r->block;
+	int full;
+
+	if (r->header.format == RECORDER_DELTA)
+		full = (b->count == RECORDER_KEYFRAME_INTERVAL) || (r->block_len + RECORDER_MAX_DELTA > RECORDER_BLOCK_SIZE);
+	else
+		full = (r->block_len + sizeof(*rec) > RECORDER_BLOCK_SIZE);
+
+	if (full) {
+		recorder_end_block(r);
+
+		// the file is full, continue with the next one
+		if (r->block_offset + RECORDER_BLOCK_SIZE > r->file_size) {
+			recorder_file_finish(r);
+			r->header.segment++;
+			recorder_file_start(r);
+		}
+	}
+
+	if (b->count == 0) {
+		b->first_seq = rec->seq;
+		b->time = rec->time;
+	}
+	if (r->header.format == RECORDER_DELTA)
+		r->block_len += recorder_encode(&r->delta, r->block + r->block_len, rec);
+	else {
+		memcpy(r->block + r->block_len, rec, sizeof(*rec));
+		r->block_len += sizeof(*rec);
+	}
+	b->count++;
+
+	if (r->records == 0)
+		r->first_seq = rec->seq;
+	r->last_seq = rec->seq;
+	r->records++;
+	r->last = *rec;
+	r->have_last = 1;
+}
+
+// move the records from the ring into blocks, returns the number taken
+static unsigned int recorder_drain(t_recorder *r)
+{
+	unsigned int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&r->head, memory_order_acquire);
+	unsigned int n = head - tail;
+
+	for (; tail != head; tail++)
+		recorder_add(r, &r->slots[tail & (RECORDER_RING_SIZE-1)]);
+	atomic_store_explicit(&r->tail, tail, memory_order_release);
+	return n;
+}
+
+static void *recorder_thread(void *arg)
+{
+	t_recorder *r = arg;
+	struct timespec interval = {0, RECORDER_POLL_INTERVAL};
+	struct timespec now, flushed;
+	int running, pending = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &flushed);
+	do {
+		running = atomic_load_explicit(&r->running, memory_order_acquire);
+		if (recorder_drain(r))
+			pending = 1;
+
+		// make the partly filled block durable
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (pending && running && (now.tv_sec - flushed.tv_sec >= RECORDER_FLUSH_INTERVAL)) {
+			if (((t_recorder_block *)r->block)->count)
+				recorder_write_block(r);
+			if (r->fd >= 0)
+				fdatasync(r->fd);
+			flushed = now;
+			pending = 0;
+		}
+
+		if (running)
+			nanosleep(&interval, NULL);
+	} while (running);
+
+	recorder_file_finish(r);
+	return NULL;
+}
+
+/**
+* @brief Open a binary recording and start its writer thread
+* @param r pointer to recorder instance
+* @param path recording, the files are numbered <path>.000, <path>.001, ...
+* @param format RECORDER_FULL or RECORDER_DELTA
+* @param file_size size of a file in MB before the next one is started
+* @param state raw log header with the sensor state at the start
+* @param state_len length of the state
+* @return result
+*
+* The ring and the block buffer are allocated and touched here, so the
+* producer never waits for the writer or a page fault.
+*
+* @date 18.10.2026 born
+*
+*/
+int recorder_open(t_recorder *r, const char *path, int format, int file_size, const char *state, size_t state_len)
+{
+	sigset_t all, old;
+	struct timespec now;
+	int err;
+
+	memset(r, 0, sizeof(*r));
+	snprintf(r->path, sizeof(r->path), "%s", path);
+	r->file_size = (long)file_size << 20;
+	if (r->file_size < RECORDER_ALIGN + RECORDER_BLOCK_SIZE)
+		r->file_size = RECORDER_ALIGN + RECORDER_BLOCK_SIZE;
+
+	if (posix_memalign((void **)&r->slots, RECORDER_ALIGN, RECORDER_RING_SIZE * sizeof(t_recorder_record)) ||
+		posix_memalign((void **)&r->block, RECORDER_ALIGN, RECORDER_BLOCK_SIZE)) {
+		fprintf(stderr, "Recorder: out of memory\n");
+		return 1;
+	}
+	memset(r->slots, 0, RECORDER_RING_SIZE * sizeof(t_recorder_record));
+	atomic_init(&r->head, 0);
+	atomic_init(&r->tail, 0);
+	atomic_init(&r->dropped, 0);
+
+	r->header.magic = RECORDER_MAGIC;
+	r->header.version = RECORDER_VERSION;
+	r->header.format = format;
+	r->header.block_size = RECORDER_BLOCK_SIZE;
+	r->header.record_size = sizeof(t_recorder_record);
+	clock_gettime(CLOCK_REALTIME, &now);
+	r->header.time = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+	if (state_len > sizeof(r->header.state))
+		state_len = sizeof(r->header.state);
+	memcpy(r->header.state, state, state_len);
+	r->header.state_len = state_len;
+
+	if (recorder_file_start(r))
+		return 1;
+
+	// the writer does not take any signals
+	atomic_init(&r->running, 1);
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	err = pthread_create(&r->thread, NULL, recorder_thread, r);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (err != 0) {
+		fprintf(stderr, "Unable to start recorder thread: %s\n", strerror(err));
+		atomic_store(&r->running, 0);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Queue a sample for the writer thread, called by the producer only
+* @param r pointer to recorder instance
+* @param sample
+* @return 0 on success, 1 if the ring is full
+*
+* @date 18.10.2026 born
+*
+*/
+int recorder_push(t_recorder *r, const t_sample *sample)
+{
+	unsigned int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+	t_recorder_record *rec;
+
+	if (head - tail >= RECORDER_RING_SIZE) {
+		atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+		return 1;
+	}
+
+	rec = &r->slots[head & (RECORDER_RING_SIZE-1)];
+	rec->seq = sample->seq;
+	rec->flags = (sample->record ? RECORDER_RECORD : 0) | (sample->reject ? RECORDER_REJECT : 0) |
+		((sample->tep_valid == 1) ? RECORDER_TEP_VALID : 0);
+	rec->time = (int64_t)sample->t_sensor.tv_sec * 1000000000 + sample->t_sensor.tv_nsec;
+	rec->late = sample->late;
+	rec->tep_adc = sample->tep_adc;
+	rec->static_adc = sample->static_adc;
+	rec->static_D1 = sample->static_D1;
+	rec->static_D1f = sample->static_D1f;
+	rec->static_D2 = sample->static_D2;
+	rec->static_D2f = sample->static_D2f;
+	rec->tep_D1 = sample->tep_D1;
+	rec->tep_D1f = sample->tep_D1f;
+	rec->tep_D2 = sample->tep_D2;
+	rec->tep_D2f = sample->tep_D2f;
+	rec->digoutp = sample->digoutp;
+	rec->digoutT = sample->digoutT;
+	rec->voltage_raw = sample->voltage_raw;
+	rec->glitch = sample->glitch;
+	rec->glitchstart = sample->glitchstart;
+	rec->deltaxmax = sample->deltaxmax;
+	rec->shutoff = sample->shutoff;
+	rec->p_tep = sample->p_tep;
+	rec->p_static_raw = sample->p_static_raw;
+	rec->p_dynamic_raw = sample->p_dynamic_raw;
+	rec->p_static = sample->p_static;
+	rec->p_dynamic = sample->p_dynamic;
+	rec->x_abs = sample->x_abs;
+	rec->x_vel = sample->x_vel;
+	rec->p_abs_abs = sample->p_abs_abs;
+	rec->p_abs_vel = sample->p_abs_vel;
+	rec->p_vel_vel = sample->p_vel_vel;
+	atomic_store_explicit(&r->head, head + 1, memory_order_release);
+	return 0;
+}
+
+/**
+* @brief Stop the writer thread, it writes what is queued and closes the file
+* @param r pointer to recorder instance
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void recorder_close(t_recorder *r)
+{
+	unsigned long dropped;
+
+	if (!atomic_load(&r->running))
+		return;
+
+	atomic_store_explicit(&r->running, 0, memory_order_release);
+	pthread_join(r->thread, NULL);
+
+	dropped = atomic_load(&r->dropped);
+	if (dropped)
+		fprintf(stderr, "Recorder: %lu samples dropped\n", dropped);
+	free(r->slots);
+	free(r->block);
+}
+
+
+// rebuild the index of a file which was not closed cleanly
+static void recorder_file_scan(t_recorder_file *f, long size)
+{
+	t_recorder_block b;
+	long offset = RECORDER_ALIGN;
+	uint32_t n = 0, size_index = 0;
+
+	while ((offset + (long)sizeof(b) <= size) && (fseek(f->fp, offset, SEEK_SET) == 0) &&
+		(fread(&b, sizeof(b), 1, f->fp) == 1) && (b.magic == RECORDER_BLOCK_MAGIC) &&
+		(b.size <= RECORDER_BLOCK_SIZE)) {
+		if (n == size_index) {
+			t_recorder_index *index = realloc(f->index, (n + 256) * sizeof(*index));
+			if (index == NULL)
+				break;
+			f->index = index;
+			size_index += 256;
+		}
+		f->index[n].first_seq = b.first_seq;
+		f->index[n].count = b.count;
+		f->index[n].time = b.time;
+		f->index[n].offset = offset;
+		n++;
+		offset += ALIGN_UP(sizeof(b) + b.size);
+	}
+	f->blocks = n;
+}
+
+/**
+* @brief Open one file of a recording for reading
+* @param f pointer to reader instance
+* @param path file name
+* @return result
+*
+* The index is taken from the end of the file, a file which was not closed
+* cleanly is scanned for its blocks.
+*
+* @date 18.10.2026 born
+*
+*/
+int recorder_file_open(t_recorder_file *f, const char *path)
+{
+	t_recorder_trailer t;
+	uint32_t crc;
+	long size;
+
+	memset(f, 0, sizeof(*f));
+	f->fp = fopen(path, "r");
+	if (f->fp == NULL) {
+		fprintf(stderr, "Unable to open %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	if (fread(&f->header, sizeof(f->header), 1, f->fp) != 1)
+		goto broken;
+	crc = f->header.crc;
+	f->header.crc = 0;
+	if ((f->header.magic != RECORDER_MAGIC) || (crc != crc32_ieee(&f->header, sizeof(f->header))))
+		goto broken;
+	if ((f->header.version != RECORDER_VERSION) || (f->header.block_size != RECORDER_BLOCK_SIZE) ||
+		(f->header.record_size != sizeof(t_recorder_record)) || (f->header.format > RECORDER_DELTA)) {
+		fprintf(stderr, "%s: unsupported recording version %u\n", path, f->header.version);
+		fclose(f->fp);
+		return 1;
+	}
+
+	f->block = malloc(RECORDER_BLOCK_SIZE);
+	if (f->block == NULL) {
+		fclose(f->fp);
+		return 1;
+	}
+
+	fseek(f->fp, 0, SEEK_END);
+	size = ftell(f->fp);
+	if ((size >= (long)(RECORDER_ALIGN + sizeof(t))) && (fseek(f->fp, size - sizeof(t), SEEK_SET) == 0) &&
+		(fread(&t, sizeof(t), 1, f->fp) == 1) && (t.magic == RECORDER_TRAILER_MAGIC) &&
+		(t.crc == crc32_ieee(&t, offsetof(t_recorder_trailer, crc)))) {
+		size_t len = t.blocks * sizeof(t_recorder_index);
+
+		f->index = malloc(len + 1);
+		if ((f->index != NULL) && (fseek(f->fp, size - sizeof(t) - len, SEEK_SET) == 0) &&
+			(fread(f->index, 1, len, f->fp) == len) && (t.index_crc == crc32_ieee(f->index, len))) {
+			f->blocks = t.blocks;
+			f->complete = 1;
+			return 0;
+		}
+	}
+
+	recorder_file_scan(f, size);
+	return 0;
+
+broken:
+	fprintf(stderr, "%s is not a sensord recording\n", path);
+	fclose(f->fp);
+	return 1;
+}
+
+// load the next block of the index, damaged blocks are reported and skipped
+static int recorder_file_load(t_recorder_file *f)
+{
+	t_recorder_block b;
+
+	while (f->block_no < f->blocks) {
+		uint32_t n = f->block_no++;
+
+		if ((fseek(f->fp, f->index[n].offset, SEEK_SET) != 0) || (fread(&b, sizeof(b), 1, f->fp) != 1) ||
+			(b.magic != RECORDER_BLOCK_MAGIC) || (b.size > RECORDER_BLOCK_SIZE) || (b.size < sizeof(t_recorder_keyframe)) ||
+			(fread(f->block, 1, b.size, f->fp) != b.size) || (b.crc != crc32_ieee(f->block, b.size))) {
+			fprintf(stderr, "Block %u damaged, skipped\n", n);
+			continue;
+		}
+
+		memcpy(&f->keyframe, f->block, sizeof(f->keyframe));
+		f->pos = sizeof(t_recorder_keyframe);
+		f->len = b.size;
+		f->count = b.count;
+		f->next = 0;
+		memset(&f->delta, 0, sizeof(f->delta));
+		return 0;
+	}
+	return 1;
+}
+
+/**
+* @brief Continue reading at a block
+* @param f pointer to reader instance
+* @param block number of the block in the index
+* @return result
+*
+* The block is loaded, its keyframe is available in f->keyframe.
+*
+* @date 18.10.2026 born
+*
+*/
+int recorder_file_seek(t_recorder_file *f, uint32_t block)
+{
+	if (block >= f->blocks)
+		return 1;
+	f->block_no = block;
+	f->next = f->count = 0;
+	return recorder_file_load(f);
+}
+
+/**
+* @brief Read the next record
+* @param f pointer to reader instance
+* @param rec
+* @return 0 on success, 1 at the end of the file
+*
+* Records of the delta format only carry the raw sensor words, seq and
+* time.
+*
+* @date 18.10.2026 born
+*
+*/
+int recorder_file_read(t_recorder_file *f, t_recorder_record *rec)
+{
+	size_t n;
+
+	while (f->next >= f->count)
+		if (recorder_file_load(f))
+			return 1;
+
+	if (f->header.format == RECORDER_DELTA) {
+		n = recorder_decode(&f->delta, f->block + f->pos, f->len - f->pos, rec);
+		if (n == 0) {
+			fprintf(stderr, "Block %u damaged, rest skipped\n", f->block_no - 1);
+			f->next = f->count;
+			return recorder_file_read(f, rec);
+		}
+	} else {
+		n = sizeof(*rec);
+		if (f->pos + n > f->len)
+			return 1;
+		memcpy(rec, f->block + f->pos, n);
+	}
+	f->pos += n;
+	f->next++;
+	return 0;
+}
+
+void recorder_file_close(t_recorder_file *f)
+{
+	fclose(f->fp);
+	free(f->block);
+	free(f->index);
+}
+
+/**
+* @brief Turn a record back into a sample for the text formats
+* @param rec
+* @param sample
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void recorder_unpack(const t_recorder_record *rec, t_sample *sample)
+{
+	memset(sample, 0, sizeof(*sample));
+	sample->seq = rec->seq;
+	sample->record = (rec->flags & RECORDER_RECORD) ? 1 : 0;
+	sample->reject = (rec->flags & RECORDER_REJECT) ? 1 : 0;
+	sample->tep_valid = (rec->flags & RECORDER_TEP_VALID) ? 1 : 0;
+	sample->t_sensor.tv_sec = rec->time / 1000000000;
+	sample->t_sensor.tv_nsec = rec->time % 1000000000;
+	sample->late = rec->late;
+	sample->tep_adc = rec->tep_adc;
+	sample->static_adc = rec->static_adc;
+	sample->static_D1 = rec->static_D1;
+	sample->static_D1f = rec->static_D1f;
+	sample->static_D2 = rec->static_D2;
+	sample->static_D2f = rec->static_D2f;
+	sample->tep_D1 = rec->tep_D1;
+	sample->tep_D1f = rec->tep_D1f;
+	sample->tep_D2 = rec->tep_D2;
+	sample->tep_D2f = rec->tep_D2f;
+	sample->digoutp = rec->digoutp;
+	sample->digoutT = rec->digoutT;
+	sample->voltage_raw = rec->voltage_raw;
+	sample->glitch = rec->glitch;
+	sample->glitchstart = rec->glitchstart;
+	sample->deltaxmax = rec->deltaxmax;
+	sample->shutoff = rec->shutoff;
+	sample->p_tep = rec->p_tep;
+	sample->p_static_raw = rec->p_static_raw;
+	sample->p_dynamic_raw = rec->p_dynamic_raw;
+	sample->p_static = rec->p_static;
+	sample->p_dynamic = rec->p_dynamic;
+	sample->x_abs = rec->x_abs;
+	sample->x_vel = rec->x_vel;
+	sample->p_abs_abs = rec->p_abs_abs;
+	sample->p_abs_vel = rec->p_abs_vel;
+	sample->p_vel_vel = rec->p_vel_vel;
+}
@@ -0,0 +1,232 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ring.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define RECORDER_MAGIC 0x43455253		// "SREC"
+#define RECORDER_BLOCK_MAGIC 0x4b4c4253		// "SBLK"
+#define RECORDER_TRAILER_MAGIC 0x444e4553	// "SEND"
+#define RECORDER_VERSION 2
+
+// record formats
+#define RECORDER_FULL 0			// all values of a tick as t_recorder_record
+#define RECORDER_DELTA 1		// raw sensor words, delta coded
+
+// size of the file header, blocks follow each other aligned to RECORDER_BLOCK_ALIGN
+#define RECORDER_ALIGN 4096
+#define RECORDER_BLOCK_ALIGN 16
+#define RECORDER_BLOCK_SIZE 65536
+
+// a delta block starts with a keyframe at least every 10 s
+#define RECORDER_KEYFRAME_INTERVAL 800
+
+// largest delta coded record in bytes
+#define RECORDER_MAX_DELTA 64
+
+// records between the output and the writer thread, must be a power of two
+#define RECORDER_RING_SIZE 4096
+
+// the writer polls the ring every 50 ms and writes a partly filled block every second
+#define RECORDER_POLL_INTERVAL 50000000
+#define RECORDER_FLUSH_INTERVAL 1
+
+// default size of a file before the next one is started, in MB
+#define RECORDER_FILE_SIZE 64
+
+// record flags
+#define RECORDER_RECORD 0x01		// sample belongs to the pressure data log
+#define RECORDER_REJECT 0x02
+#define RECORDER_TEP_VALID 0x04
+
+// one sensor tick, all values in native byte order
+typedef struct {
+	uint32_t seq;
+	uint32_t flags;
+	int64_t time;			// sensor clock in ns
+	float late;			// tick lateness in us
+	uint32_t tep_adc;		// raw ADC words read in this tick
+	uint32_t static_adc;
+	uint32_t static_D1;		// after glitch compensation
+	uint32_t static_D1f;
+	uint32_t static_D2;
+	uint32_t static_D2f;
+	uint32_t tep_D1;
+	uint32_t tep_D1f;
+	uint32_t tep_D2;
+	uint32_t tep_D2f;
+	uint16_t digoutp;		// AMS5915 counts
+	uint16_t digoutT;
+	int32_t voltage_raw;
+	int32_t glitch;
+	int32_t glitchstart;
+	int32_t deltaxmax;
+	int32_t shutoff;
+	float p_tep;			// pressures of this tick
+	float p_static_raw;
+	float p_dynamic_raw;
+	float p_static;			// filter output
+	float p_dynamic;
+	float x_abs;
+	float x_vel;
+	float p_abs_abs;
+	float p_abs_vel;
+	float p_vel_vel;
+} t_recorder_record;
+
+// start of every file, padded to RECORDER_ALIGN
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t block_size;
+	uint32_t record_size;
+	uint32_t segment;		// number of the file in a rotated recording
+	uint32_t state_len;
+	int64_t time;			// CLOCK_REALTIME when the recording was started
+	uint32_t crc;			// CRC-32 of the header with crc set to 0
+	uint32_t format;		// RECORDER_FULL or RECORDER_DELTA
+	char state[RECORDER_ALIGN - 40];	// raw log header, empty in a pressure replay
+} t_recorder_header;
+
+// start of every block, followed by a keyframe and the records
+typedef struct {
+	uint32_t magic;
+	uint32_t count;
+	uint32_t first_seq;
+	uint32_t size;			// bytes after the block header
+	int64_t time;			// sensor clock of the first record
+	uint32_t crc;			// CRC-32 of the bytes after the block header
+	uint32_t reserved;
+} t_recorder_block;
+
+// state of the pressure path before the first record of a block
+typedef struct {
+	uint32_t valid;			// 0 at the start, the file header has the state
+	uint32_t static_D1;
+	uint32_t static_D1f;
+	uint32_t static_D2;
+	uint32_t static_D2f;
+	uint32_t tep_D1;
+	uint32_t tep_D1f;
+	uint32_t tep_D2;
+	uint32_t tep_D2f;
+	int32_t glitch;
+	int32_t glitchstart;
+	int32_t deltaxmax;
+	int32_t shutoff;
+	float x_abs;
+	float x_vel;
+	float p_abs_abs;
+	float p_abs_vel;
+	float p_vel_vel;
+	float p_static;
+	float p_dynamic;
+} t_recorder_keyframe;
+
+// one entry per block, written before the trailer
+typedef struct {
+	uint32_t first_seq;
+	uint32_t count;
+	int64_t time;			// sensor clock of the first record
+	uint64_t offset;		// of the block in the file
+} t_recorder_index;
+
+// end of a file which was closed cleanly
+typedef struct {
+	uint32_t magic;
+	uint32_t blocks;		// number of index entries in front of the trailer
+	uint64_t records;
+	uint32_t first_seq;
+	uint32_t last_seq;
+	uint32_t index_crc;		// CRC-32 of the index
+	uint32_t crc;			// CRC-32 of the trailer up to here
+} t_recorder_trailer;
+
+// delta coder state, reset at the start of every block
+typedef struct {
+	t_recorder_record prev;
+	int64_t dt;			// time step of the previous record without lateness
+	uint32_t tep_adc;		// words of the record before prev, same conversion type
+	uint32_t static_adc;
+} t_recorder_delta;
+
+typedef struct {
+	// ring, written by the producer and drained by the writer thread
+	t_recorder_record *slots;
+	_Atomic unsigned int head;
+	_Atomic unsigned int tail;
+	atomic_ulong dropped;
+	atomic_int running;
+	pthread_t thread;
+
+	// owned by the writer thread
+	char path[64];
+	long file_size;			// in bytes, a new file is started beyond
+	int fd;
+	t_recorder_header header;
+	uint8_t *block;			// RECORDER_BLOCK_SIZE, aligned
+	size_t block_len;		// bytes used in block
+	off_t block_offset;
+	t_recorder_delta delta;
+	t_recorder_record last;		// most recent record, source of the keyframes
+	int have_last;
+	t_recorder_index *index;
+	uint32_t index_size;
+	uint32_t blocks;
+	uint64_t records;
+	uint32_t first_seq;
+	uint32_t last_seq;
+	unsigned long errors;
+} t_recorder;
+
+// reads a recording written by t_recorder
+typedef struct {
+	FILE *fp;
+	t_recorder_header header;
+	t_recorder_index *index;
+	uint32_t blocks;
+	int complete;			// closed cleanly, the index is from the file
+	uint8_t *block;
+	t_recorder_keyframe keyframe;	// of the current block
+	uint32_t block_no;		// next block to load
+	uint32_t count;			// records in the current block
+	uint32_t next;			// next record in the current block
+	size_t pos;			// read position in the current block
+	size_t len;
+	t_recorder_delta delta;
+} t_recorder_file;
+
+int recorder_open(t_recorder *, const char *, int, int, const char *, size_t);
+int recorder_push(t_recorder *, const t_sample *);
+void recorder_close(t_recorder *);
+
+size_t recorder_encode(t_recorder_delta *, uint8_t *, const t_recorder_record *);
+size_t recorder_decode(t_recorder_delta *, const uint8_t *, size_t, t_recorder_record *);
+
+int recorder_file_open(t_recorder_file *, const char *);
+int recorder_file_seek(t_recorder_file *, uint32_t);
+int recorder_file_read(t_recorder_file *, t_recorder_record *);
+void recorder_file_close(t_recorder_file *);
+void recorder_unpack(const t_recorder_record *, t_sample *);
@@ -0,0 +1,110 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+int ring_init(t_ring *r)
+{
+	atomic_init(&r->head, 0);
+	atomic_init(&r->tail, 0);
+	atomic_init(&r->eof, 0);
+	atomic_init(&r->dropped, 0);
+
+	r->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (r->fd < 0) {
+		fprintf(stderr, "eventfd failed: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+static void ring_notify(t_ring *r)
+{
+	uint64_t one = 1;
+
+	// can only fail if the counter overflows, the consumer is woken up anyway
+	if (write(r->fd, &one, sizeof(one)) != sizeof(one)) {}
+}
+
+/**
+* @brief Publish a sample, called by the producer only
+* @param r pointer to ring
+* @param sample
+* @return 0 on success, 1 if the ring is full
+*
+* Never blocks. A full ring means the consumer fell behind and the sample
+* is not published.
+*
+* @date 18.10.2026 born
+*
+*/
+int ring_push(t_ring *r, const t_sample *sample)
+{
+	unsigned int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+	if (head - tail >= RING_SIZE)
+		return 1;
+
+	r->slots[head & (RING_SIZE-1)] = *sample;
+	atomic_store_explicit(&r->head, head + 1, memory_order_release);
+	ring_notify(r);
+	return 0;
+}
+
+/**
+* @brief Take the oldest sample, called by the consumer only
+* @param r pointer to ring
+* @param sample
+* @return 1 if a sample was taken, 0 if the ring is empty
+*
+* @date 18.10.2026 born
+*
+*/
+int ring_pop(t_ring *r, t_sample *sample)
+{
+	unsigned int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+	if (head == tail) return 0;
+
+	*sample = r->slots[tail & (RING_SIZE-1)];
+	atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+	return 1;
+}
+
+// Producer is done, no more samples will follow
+void ring_close(t_ring *r)
+{
+	atomic_store_explicit(&r->eof, 1, memory_order_release);
+	ring_notify(r);
+}
+
+void ring_clear_notify(t_ring *r)
+{
+	uint64_t count;
+
+	if (read(r->fd, &count, sizeof(count)) != sizeof(count)) {}
+}
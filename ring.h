@@ -0,0 +1,89 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// number of slots, must be a power of two
+#define RING_SIZE 128
+
+// one record per sensor tick, published by the acquisition thread
+typedef struct {
+	unsigned long seq;
+	struct timespec time;		// tick time after filtering, CLOCK_MONOTONIC
+	struct timespec t_conv;		// start of the conversion read in this tick
+	struct timespec t_read;		// conversion result read
+	struct timespec t_sensor;	// sensor clock of this tick, time base of a raw replay
+	float late;			// tick lateness in us
+	float p_static;			// filtered static pressure in Pa
+	float p_dynamic;		// filtered dynamic pressure in hPa
+	float p_tep;			// TE pressure in Pa
+	float p_static_raw;		// static pressure of this tick in Pa
+	float p_dynamic_raw;		// dynamic pressure of this tick in hPa
+	float x_abs;			// Kalman filter state
+	float x_vel;
+	float voltage;
+	uint32_t static_D1;
+	uint32_t static_D1f;
+	uint32_t static_D2;
+	uint32_t static_D2f;
+	uint32_t tep_D1;
+	uint32_t tep_D1f;
+	uint32_t tep_D2;
+	uint32_t tep_D2f;
+	uint32_t tep_adc;		// raw ADC words read in this tick, before compensation
+	uint32_t static_adc;
+	uint16_t digoutp;		// AMS5915 counts
+	uint16_t digoutT;
+	int voltage_raw;
+	int glitch;
+	int glitchstart;		// rest of the glitch detection state
+	int deltaxmax;
+	int shutoff;
+	float p_abs_abs;		// Kalman filter covariance
+	float p_abs_vel;
+	float p_vel_vel;
+	char tep_valid;
+	char reject;
+	char record;			// sample goes to the data log
+} t_sample;
+
+// wait-free single producer / single consumer ring
+typedef struct {
+	t_sample slots[RING_SIZE];
+	_Atomic unsigned int head;	// written by producer
+	_Atomic unsigned int tail;	// written by consumer
+	atomic_int eof;
+	atomic_ulong dropped;
+	int fd;				// eventfd to wake up the consumer
+} t_ring;
+
+int ring_init(t_ring *);
+int ring_push(t_ring *, const t_sample *);
+int ring_pop(t_ring *, t_sample *);
+void ring_close(t_ring *);
+void ring_clear_notify(t_ring *);
+
+static inline int ring_eof(t_ring *r)
+{
+	return atomic_load_explicit(&r->eof, memory_order_acquire);
+}
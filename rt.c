@@ -0,0 +1,119 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rt.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+/**
+* @brief Lock all current and future memory of the process
+* @return result
+*
+* The heap is never given back to the kernel and large allocations are not
+* served by mmap, so memory once faulted in stays resident.
+*
+* @date 18.10.2026 born
+*
+*/
+int rt_lock_memory(void)
+{
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		fprintf(stderr, "mlockall failed: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Touch the stack so it never page faults later
+* @param size number of bytes below the current stack frame
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void rt_prefault_stack(size_t size)
+{
+	volatile unsigned char *stack = __builtin_alloca(size);
+	size_t i;
+
+	for (i = 0; i < size; i += 4096)
+		stack[i] = 0;
+}
+
+/**
+* @brief Start a SCHED_FIFO thread
+* @param thread
+* @param start thread function
+* @param arg argument for thread function
+* @param priority SCHED_FIFO priority
+* @param cpu CPU to pin the thread to, -1 for no affinity
+* @return result
+*
+* The thread gets a fixed stack of RT_STACK_SIZE bytes.
+*
+* @date 18.10.2026 born
+*
+*/
+int rt_thread_create(pthread_t *thread, void *(*start)(void *), void *arg, int priority, int cpu)
+{
+	pthread_attr_t attr;
+	struct sched_param param;
+	cpu_set_t cpus;
+	int result;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, RT_STACK_SIZE);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+	pthread_attr_setschedparam(&attr, &param);
+
+	if (cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		result = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+		if (result != 0) {
+			fprintf(stderr, "Unable to pin real time thread to cpu %d: %s\n", cpu, strerror(result));
+			pthread_attr_destroy(&attr);
+			return 1;
+		}
+	}
+
+	result = pthread_create(thread, &attr, start, arg);
+	pthread_attr_destroy(&attr);
+
+	if (result != 0) {
+		fprintf(stderr, "Unable to start real time thread: %s\n", strerror(result));
+		return 1;
+	}
+
+	debug_print("Real time thread started, priority %d, cpu %d\n", priority, cpu);
+	return 0;
+}
@@ -0,0 +1,33 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <pthread.h>
+
+// stack size of the real time thread, all of it is pre-faulted
+#define RT_STACK_SIZE (256*1024)
+
+// part of the main thread stack which is pre-faulted
+#define RT_MAIN_STACK_PREFAULT (128*1024)
+
+int rt_lock_memory(void);
+void rt_prefault_stack(size_t);
+int rt_thread_create(pthread_t *, void *(*)(void *), void *, int, int);
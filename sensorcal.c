@@ -35,6 +35,7 @@ static int calibrate_ams5915(t_eeprom_data* data)
 	// open sensor for differential pressure
 	/// @todo remove hardcoded i2c address for differential pressure
 	printf("Open sensor ...");
+	dynamic_sensor.bus = 1;
 	if (ams5915_open(&dynamic_sensor, 0x28) != 0)
 	{
 		printf(" failed !!\n");
@@ -69,6 +70,7 @@ static int calibrate_ams5915(t_eeprom_data* data)
 	}
 
 	data->zero_offset = -1*(offset/800);
+	i2cbus_close(&dynamic_sensor.dev);
 
 	return(0);
 }
@@ -104,6 +106,7 @@ int main (int argc, char **argv) {
 	printf("This is free software, and you are welcome to redistribute it under certain conditions;\n");
 
 	// open eeprom object
+	eeprom.bus = 1;
 	result = eeprom_open(&eeprom, 0x50);
 	if (result != 0)
 	{
@@ -0,0 +1,214 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static void server_drop_client(t_client *c, const char *reason)
+{
+	fprintf(stderr, "%s client %d %s, %lu updates dropped\n", c->server->name, (int)(c - c->server->clients), reason, c->queue.dropped);
+	reactor_remove_fd(c->server->reactor, c->fd);
+	close(c->fd);
+	c->fd = -1;
+}
+
+// clients only receive, one which shut down its sending side is kept
+static uint32_t server_client_events(t_client *c)
+{
+	return (c->eof ? 0 : EPOLLIN) | (outq_pending(&c->queue) ? EPOLLOUT : 0);
+}
+
+static void server_client_handler(void *ctx, uint32_t events)
+{
+	t_client *c = ctx;
+	char buf[256];
+	ssize_t n;
+	int result;
+
+	if (events & (EPOLLERR|EPOLLHUP)) {
+		server_drop_client(c, "closed");
+		return;
+	}
+
+	// nothing is expected from the clients, input is discarded
+	if (events & EPOLLIN) {
+		n = read(c->fd, buf, sizeof(buf));
+		if ((n < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+			server_drop_client(c, "closed");
+			return;
+		}
+		if (n == 0) {
+			c->eof = 1;
+			reactor_modify_fd(c->server->reactor, c->fd, server_client_events(c));
+		}
+	}
+
+	if (events & EPOLLOUT) {
+		result = outq_flush(&c->queue, c->fd);
+		if (result < 0)
+			server_drop_client(c, "send failed");
+		else if (result == 0)
+			reactor_modify_fd(c->server->reactor, c->fd, server_client_events(c));
+	}
+}
+
+static void server_accept_handler(void *ctx, uint32_t events)
+{
+	t_server *s = ctx;
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+	int fd, i;
+
+	(void)events;
+
+	fd = accept4(s->fd, (struct sockaddr *)&addr, &len, SOCK_NONBLOCK|SOCK_CLOEXEC);
+	if (fd < 0) {
+		if ((errno != EAGAIN) && (errno != EINTR))
+			fprintf(stderr, "accept failed: %s\n", strerror(errno));
+		return;
+	}
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+		if (s->clients[i].fd < 0) break;
+
+	if (i == SERVER_MAX_CLIENTS) {
+		fprintf(stderr, "Too many %s clients, %s rejected\n", s->name, inet_ntoa(addr.sin_addr));
+		close(fd);
+		return;
+	}
+
+	outq_init(&s->clients[i].queue);
+	s->clients[i].eof = 0;
+	outq_config(&s->clients[i].queue, s->queue_size, (s->policy == SERVER_DROP_OLDEST) ? OUTQ_DROP_OLDEST : OUTQ_DROP_NEWEST);
+	if (reactor_add_fd(s->reactor, fd, EPOLLIN, REACTOR_PRIO_OUTPUT, server_client_handler, &s->clients[i]) != 0) {
+		close(fd);
+		return;
+	}
+	s->clients[i].fd = fd;
+	fprintf(stderr, "%s client %d connected from %s:%u\n", s->name, i, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+}
+
+/**
+* @brief Listen for clients of a stream
+* @param s pointer to server instance
+* @param r reactor serving the clients
+* @param name of the stream, for messages
+* @param address IPv4 address to listen on, 0.0.0.0 for all interfaces
+* @param port TCP port
+* @param queue_size max. pending bytes per client
+* @param policy SERVER_DROP_OLDEST or SERVER_DISCONNECT
+* @return result
+*
+* @date 18.10.2026 born
+*
+*/
+int server_open(t_server *s, t_reactor *r, const char *name, const char *address, uint16_t port, size_t queue_size, int policy)
+{
+	struct sockaddr_in addr;
+	int i, on = 1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_aton(address, &addr.sin_addr) == 0) {
+		fprintf(stderr, "Invalid listen address %s\n", address);
+		return 1;
+	}
+
+	s->reactor = r;
+	s->name = name;
+	s->queue_size = queue_size;
+	s->policy = policy;
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++) {
+		s->clients[i].fd = -1;
+		s->clients[i].server = s;
+	}
+
+	s->fd = socket(AF_INET, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+	if (s->fd < 0) {
+		fprintf(stderr, "could not create socket: %s\n", strerror(errno));
+		return 1;
+	}
+	setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	if ((bind(s->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(s->fd, SERVER_MAX_CLIENTS) < 0)) {
+		fprintf(stderr, "could not listen on %s:%u: %s\n", address, port, strerror(errno));
+		close(s->fd);
+		return 1;
+	}
+
+	if (reactor_add_fd(r, s->fd, EPOLLIN, REACTOR_PRIO_OUTPUT, server_accept_handler, s) != 0) {
+		close(s->fd);
+		return 1;
+	}
+	fprintf(stderr, "Listening for %s clients on %s:%u\n", name, address, port);
+	return 0;
+}
+
+/**
+* @brief Send data to all clients
+* @param s pointer to server instance
+* @param data
+* @param len
+* @return
+*
+* A client which doesn't keep up loses the oldest data, or is disconnected,
+* depending on the policy. The other clients are not affected.
+*
+* @date 18.10.2026 born
+*
+*/
+void server_send(t_server *s, const char *data, size_t len)
+{
+	t_client *c;
+	int pending, result;
+
+	for (c = s->clients; c < s->clients + SERVER_MAX_CLIENTS; c++) {
+		if (c->fd < 0) continue;
+
+		pending = outq_pending(&c->queue);
+		result = outq_write(&c->queue, c->fd, data, len);
+		if (result < 0)
+			server_drop_client(c, "send failed");
+		else if ((result > 0) && (s->policy == SERVER_DISCONNECT))
+			server_drop_client(c, "too slow");
+		else if (!pending && outq_pending(&c->queue))
+			reactor_modify_fd(s->reactor, c->fd, server_client_events(c));
+	}
+}
+
+void server_close(t_server *s)
+{
+	int i;
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+		if (s->clients[i].fd >= 0)
+			server_drop_client(&s->clients[i], "closed");
+	reactor_remove_fd(s->reactor, s->fd);
+	close(s->fd);
+}
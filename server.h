@@ -0,0 +1,56 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "outq.h"
+#include "reactor.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SERVER_MAX_CLIENTS 8
+
+// what to do with a client which doesn't keep up
+#define SERVER_DROP_OLDEST 0
+#define SERVER_DISCONNECT 1
+
+struct s_server;
+
+typedef struct {
+	int fd;				// -1 if unused
+	struct s_server *server;
+	t_outq queue;
+	int eof;			// sending side shut down by the client
+} t_client;
+
+// listening socket fanning a stream out to all clients
+typedef struct s_server {
+	int fd;
+	const char *name;		// of the stream, for messages
+	t_reactor *reactor;
+	size_t queue_size;
+	int policy;
+	t_client clients[SERVER_MAX_CLIENTS];
+} t_server;
+
+int server_open(t_server *, t_reactor *, const char *, const char *, uint16_t, size_t, int);
+void server_send(t_server *, const char *, size_t);
+void server_close(t_server *);
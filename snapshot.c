@@ -0,0 +1,237 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "snapshot.h"
+#include "crc32.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+
+static void snapshot_capture_ms5611(t_snapshot_ms5611 *s, const t_ms5611 *sensor)
+{
+	memcpy(s->prom, sensor->prom, sizeof(s->prom));
+	s->D1 = sensor->D1;
+	s->D1f = sensor->D1f;
+	s->D2 = sensor->D2;
+	s->D2f = sensor->D2f;
+}
+
+/**
+* @brief Collect the state of the pressure path
+* @param s snapshot to fill
+* @param static_sensor
+* @param tep_sensor
+* @param glitch glitch detection state
+* @param vkf vario Kalman filter
+* @return
+*
+* @date 18.10.2026 born
+*
+*/
+void snapshot_capture(t_snapshot *s, const t_ms5611 *static_sensor, const t_ms5611 *tep_sensor, const t_glitch *glitch, const t_kalmanfilter1d *vkf)
+{
+	// clear padding, the CRC covers the raw bytes
+	memset(s, 0, sizeof(*s));
+	snapshot_capture_ms5611(&s->static_sensor, static_sensor);
+	snapshot_capture_ms5611(&s->tep_sensor, tep_sensor);
+	s->glitch = *glitch;
+	s->vkf = *vkf;
+}
+
+/**
+* @brief Publish a snapshot, called by the acquisition thread only
+* @param slot
+* @param s
+* @return
+*
+* Sequence lock, the writer never waits for the reader.
+*
+* @date 18.10.2026 born
+*
+*/
+void snapshot_publish(t_snapshot_slot *slot, const t_snapshot *s)
+{
+	unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+	atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	slot->snap = *s;
+	atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+/**
+* @brief Copy the latest published snapshot
+* @param slot
+* @param s
+* @return 0 on success, 1 if nothing was published or the copy was torn
+*
+* @date 18.10.2026 born
+*
+*/
+int snapshot_fetch(t_snapshot_slot *slot, t_snapshot *s)
+{
+	unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+	if ((seq == 0) || (seq & 1))
+		return 1;
+	*s = slot->snap;
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq;
+}
+
+/**
+* @brief Write a snapshot to disk
+* @param path file name
+* @param s snapshot, header and CRC are filled in
+* @return result, errno is set on failure
+*
+* The snapshot is written to a temporary file, synced and renamed over the
+* old one, so a power loss leaves either the old or the new snapshot.
+*
+* @date 18.10.2026 born
+*
+*/
+int snapshot_write(const char *path, t_snapshot *s)
+{
+	char tmp[PATH_MAX];
+	int fd, err;
+
+	s->magic = SNAPSHOT_MAGIC;
+	s->version = SNAPSHOT_VERSION;
+	s->time = time(NULL);
+	s->crc = crc32_ieee(s, offsetof(t_snapshot, crc));
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return 1;
+
+	if ((write(fd, s, sizeof(*s)) != sizeof(*s)) || (fdatasync(fd) != 0)) {
+		err = errno;
+		close(fd);
+		unlink(tmp);
+		errno = err;
+		return 1;
+	}
+	close(fd);
+
+	if (rename(tmp, path) != 0) {
+		err = errno;
+		unlink(tmp);
+		errno = err;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Read and check a snapshot
+* @param path file name
+* @param s snapshot to fill
+* @param max_age max. age in s
+* @return result
+*
+* A snapshot from the future is accepted, the clock of a unit without a
+* backed up RTC starts from an old date after a power cycle. The age is no
+* proof of freshness either way, see snapshot_plausible().
+*
+* @date 18.10.2026 born
+*
+*/
+int snapshot_read(const char *path, t_snapshot *s, int max_age)
+{
+	int64_t age;
+	ssize_t len;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			fprintf(stderr, "Unable to open snapshot %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	len = read(fd, s, sizeof(*s));
+	close(fd);
+
+	if ((len != sizeof(*s)) || (s->magic != SNAPSHOT_MAGIC) || (s->version != SNAPSHOT_VERSION)) {
+		fprintf(stderr, "Snapshot %s invalid\n", path);
+		return 1;
+	}
+	if (s->crc != crc32_ieee(s, offsetof(t_snapshot, crc))) {
+		fprintf(stderr, "Snapshot %s checksum wrong\n", path);
+		return 1;
+	}
+
+	age = time(NULL) - s->time;
+	if (age > max_age) {
+		fprintf(stderr, "Snapshot %s too old (%lld s)\n", path, (long long)age);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* @brief Check that a snapshot belongs to the sensors found
+* @param s snapshot
+* @param static_sensor
+* @param tep_sensor
+* @return 1 if the PROM contents of both sensors match, 0 otherwise
+*
+* @date 18.10.2026 born
+*
+*/
+int snapshot_match(const t_snapshot *s, const t_ms5611 *static_sensor, const t_ms5611 *tep_sensor)
+{
+	return (memcmp(s->static_sensor.prom, static_sensor->prom, sizeof(s->static_sensor.prom)) == 0) &&
+		(memcmp(s->tep_sensor.prom, tep_sensor->prom, sizeof(s->tep_sensor.prom)) == 0);
+}
+
+static int snapshot_temp_close(const t_snapshot_ms5611 *s, const t_ms5611 *sensor)
+{
+	int64_t delta = ((int64_t)sensor->D2 - s->D2f) * sensor->C6 / 8388608;
+
+	return (delta >= -SNAPSHOT_MAX_TEMP_DELTA) && (delta <= SNAPSHOT_MAX_TEMP_DELTA);
+}
+
+/**
+* @brief Check a snapshot against live readings
+* @param s snapshot
+* @param static_sensor with a fresh D2 reading
+* @param tep_sensor with a fresh D2 reading
+* @return 1 if both sensors are within SNAPSHOT_MAX_TEMP_DELTA of the snapshot, 0 otherwise
+*
+* The wall clock can't tell a stale snapshot from a fresh one if it was
+* reset or restored, but the sensor temperature changes little across a
+* short restart.
+*
+* @date 18.10.2026 born
+*
+*/
+int snapshot_plausible(const t_snapshot *s, const t_ms5611 *static_sensor, const t_ms5611 *tep_sensor)
+{
+	return snapshot_temp_close(&s->static_sensor, static_sensor) &&
+		snapshot_temp_close(&s->tep_sensor, tep_sensor);
+}
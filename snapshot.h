@@ -0,0 +1,75 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "ms5611.h"
+#include "KalmanFilter1d.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define SNAPSHOT_MAGIC 0x50414e53	// "SNAP"
+#define SNAPSHOT_VERSION 1
+
+// the acquisition thread publishes its state every second
+#define SNAPSHOT_PUBLISH_TICKS 80
+
+// the output thread writes it to disk every 5 s
+#define SNAPSHOT_WRITE_INTERVAL 5
+
+// max. difference of the live temperature to the snapshot in 0.01 °C
+#define SNAPSHOT_MAX_TEMP_DELTA 200
+
+// state of one MS5611
+typedef struct {
+	uint16_t prom[8];
+	uint32_t D1;
+	uint32_t D1f;
+	uint32_t D2;
+	uint32_t D2f;
+} t_snapshot_ms5611;
+
+// everything needed to resume sampling without warm-up
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	int64_t time;			// CLOCK_REALTIME when written
+	t_snapshot_ms5611 static_sensor;
+	t_snapshot_ms5611 tep_sensor;
+	t_glitch glitch;
+	t_kalmanfilter1d vkf;
+	uint32_t crc;			// CRC-32 of everything above
+} t_snapshot;
+
+// hands the latest snapshot from the acquisition to the output thread
+typedef struct {
+	atomic_uint seq;
+	t_snapshot snap;
+} t_snapshot_slot;
+
+void snapshot_capture(t_snapshot *, const t_ms5611 *, const t_ms5611 *, const t_glitch *, const t_kalmanfilter1d *);
+void snapshot_publish(t_snapshot_slot *, const t_snapshot *);
+int snapshot_fetch(t_snapshot_slot *, t_snapshot *);
+int snapshot_write(const char *, t_snapshot *);
+int snapshot_read(const char *, t_snapshot *, int);
+int snapshot_match(const t_snapshot *, const t_ms5611 *, const t_ms5611 *);
+int snapshot_plausible(const t_snapshot *, const t_ms5611 *, const t_ms5611 *);